@@ -0,0 +1,80 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace ash {
+
+namespace details {
+
+// Splits [0, n) into contiguous blocks and runs f(block, first, last) on
+// each, one thread per block. The first exception thrown is rethrown.
+class block_runner
+{
+public:
+    static const constexpr std::size_t min_block = std::size_t(1) << 15;
+
+public:
+    block_runner(std::size_t n, unsigned n_threads) :
+        n_{n},
+        blocks_{std::max<std::size_t>(1, std::min<std::size_t>(
+                    std::max(1u, n_threads), n / min_block))}
+    { }
+
+    std::size_t blocks() const noexcept
+    {
+        return blocks_;
+    }
+
+    template<typename Func>
+    void operator()(Func&& f) const
+    {
+        std::vector<std::exception_ptr> errors(blocks_);
+        auto work = [&](std::size_t b) {
+            try {
+                f(b, n_ * b / blocks_, n_ * (b + 1) / blocks_);
+            } catch (...) {
+                errors[b] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t b = 1; b < blocks_; ++b)
+            threads.emplace_back(work, b);
+        work(0);
+        for (auto& thd : threads)
+            thd.join();
+        for (auto& err : errors) {
+            if (err)
+                std::rethrow_exception(err);
+        }
+    }
+
+private:
+    std::size_t n_;
+    std::size_t blocks_;
+};
+
+} // namespace details
+
+} // namespace ash
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include "compare_base.h"
+
+namespace ash {
+
+// An immutable value stored with its hash. Hash tables keyed on it never
+// rehash the value, and unequal keys are usually told apart by the hash alone.
+template<typename T, typename Hash = std::hash<T>>
+class cached_hash : compareable<cached_hash<T, Hash>>
+{
+public:
+    using value_type = T;
+    using const_reference = const T&;
+
+public:
+    cached_hash() :
+        cached_hash(T{})
+    { }
+
+    cached_hash(const T& value) :
+        value_(value),
+        hash_(Hash{}(value_))
+    { }
+
+    cached_hash(T&& value) :
+        value_(std::move(value)),
+        hash_(Hash{}(value_))
+    { }
+
+    const_reference get() const     { return value_; }
+    operator const T&() const       { return value_; }
+    const T& operator*() const      { return value_; }
+    const T* operator->() const     { return &value_; }
+
+    std::size_t hash() const noexcept
+    {
+        return hash_;
+    }
+
+    bool operator==(const cached_hash& rhs) const
+    {
+        return hash_ == rhs.hash_ and value_ == rhs.value_;
+    }
+
+    bool operator<(const cached_hash& rhs) const
+    {
+        return value_ < rhs.value_;
+    }
+
+private:
+    T value_;
+    std::size_t hash_;
+};
+
+} // namespace ash
+
+namespace std {
+
+template<typename T, typename Hash>
+struct hash<ash::cached_hash<T, Hash>>
+{
+    std::size_t operator()(const ash::cached_hash<T, Hash>& src) const noexcept
+    {
+        return src.hash();
+    }
+};
+
+} // namespace std
@@ -0,0 +1,376 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "fixed_decimal.h"
+
+namespace ash {
+
+struct from_chars_result
+{
+    const char* ptr;
+    std::errc ec;
+};
+
+struct to_chars_result
+{
+    char* ptr;
+    std::errc ec;
+};
+
+enum class trailing_zeros
+{
+    keep,   // Always print every decimal place.
+    trim    // Drop zeros after the last significant decimal place.
+};
+
+namespace details {
+
+inline
+bool is_digit(char c) noexcept
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// Parses eight ASCII digits at once, returns false if any is not a digit.
+inline
+bool parse_eight_digits(const char* p, std::uint64_t& out) noexcept
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    if (((v & 0xF0F0F0F0F0F0F0F0) |
+            (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) !=
+            0x3333333333333333)
+        return false;
+    v -= 0x3030303030303030;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+         (((v >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+    out = v;
+    return true;
+#else
+    for (int i = 0; i != 8; ++i) {
+        if (not is_digit(p[i]))
+            return false;
+    }
+    std::uint64_t v = 0;
+    for (int i = 0; i != 8; ++i)
+        v = v * 10 + static_cast<unsigned>(p[i] - '0');
+    out = v;
+    return true;
+#endif
+}
+
+// Decimal digits as mantissa * 10^scale, keeping at most 19 significant
+// digits. Digits that did not fit are summarized for rounding.
+struct decimal_digits
+{
+    std::uint64_t mantissa = 0;
+    int scale = 0;
+    bool any_digit = false;
+    char first_dropped = 0;
+
+    static const constexpr std::uint64_t full = pow10<std::uint64_t>(18);
+
+    void push(unsigned digit, bool fraction) noexcept
+    {
+        any_digit = true;
+        if (mantissa < full) {
+            mantissa = mantissa * 10 + digit;
+            scale -= fraction;
+            return;
+        }
+        if (first_dropped == 0)
+            first_dropped = static_cast<char>('0' + digit);
+        scale += not fraction;
+    }
+
+    const char* parse_run(const char* p, const char* last, bool fraction) noexcept
+    {
+        std::uint64_t eight;
+        while (last - p >= 8 and mantissa < pow10<std::uint64_t>(11) and
+                parse_eight_digits(p, eight)) {
+            mantissa = mantissa * pow10<std::uint64_t>(8) + eight;
+            any_digit = true;
+            scale -= fraction ? 8 : 0;
+            p += 8;
+        }
+        while (p != last and is_digit(*p))
+            push(static_cast<unsigned>(*p++ - '0'), fraction);
+        return p;
+    }
+};
+
+inline
+const char* digit_pairs() noexcept
+{
+    static const char table[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+    return table;
+}
+
+inline
+unsigned count_digits(std::uint64_t v) noexcept
+{
+    unsigned n = 1;
+    while (v >= 100) {
+        v /= 100;
+        n += 2;
+    }
+    return n + (v >= 10);
+}
+
+// Writes exactly count digits of v, zero padded, ending just before last.
+inline
+void write_digits(char* last, std::uint64_t v, unsigned count) noexcept
+{
+    const char* pairs = digit_pairs();
+    for (; count >= 2; count -= 2) {
+        last -= 2;
+        std::memcpy(last, pairs + 2 * (v % 100), 2);
+        v /= 100;
+    }
+    if (count != 0)
+        *--last = static_cast<char>('0' + v);
+}
+
+// Writes [-]whole[.fraction] with places decimal places into [first, last),
+// or returns value_too_large leaving the range untouched.
+inline
+to_chars_result write_decimal(
+        char* first, char* last, bool negative, std::uint64_t magnitude,
+        unsigned places, trailing_zeros zeros) noexcept
+{
+    const std::uint64_t divisor = pow10<std::uint64_t>(places);
+    const std::uint64_t whole = magnitude / divisor;
+    std::uint64_t fraction = magnitude % divisor;
+    if (zeros == trailing_zeros::trim) {
+        for (; places != 0 and fraction % 10 == 0; --places)
+            fraction /= 10;
+    }
+
+    const unsigned whole_digits = count_digits(whole);
+    const std::size_t length =
+        negative + whole_digits + (places != 0 ? places + 1 : 0);
+    if (static_cast<std::size_t>(last - first) < length)
+        return {last, std::errc::value_too_large};
+
+    char* end = first + length;
+    if (places != 0) {
+        write_digits(end, fraction, places);
+        end[-static_cast<std::ptrdiff_t>(places) - 1] = '.';
+    }
+    write_digits(first + negative + whole_digits, whole, whole_digits);
+    if (negative)
+        *first = '-';
+    return {end, std::errc{}};
+}
+
+// Integers formatted as numbers; bool and character types are excluded so
+// that appending a char still appends the character.
+template<typename T>
+using enable_if_number_t = std::enable_if_t<
+    std::is_integral<T>::value and sizeof(T) <= 8 and
+    not std::is_same<T, bool>::value and not std::is_same<T, char>::value and
+    not std::is_same<T, signed char>::value and
+    not std::is_same<T, unsigned char>::value and
+    not std::is_same<T, wchar_t>::value and
+    not std::is_same<T, char16_t>::value and
+    not std::is_same<T, char32_t>::value, int>;
+
+// Most decimal places printed for a double, more only repeat binary noise.
+const constexpr unsigned max_double_places = 17;
+
+template<unsigned char... E>
+std::errc double_to_places(
+        double x, unsigned places, std::int64_t& out,
+        std::integer_sequence<unsigned char, E...>) noexcept
+{
+    using convert = std::errc (*)(double, std::int64_t&);
+    static const convert table[] = {
+        &double_to_raw<E, rounding::half_even, std::int64_t>...
+    };
+    return table[places](x, out);
+}
+
+} // namespace details
+
+// Parses [+-]digits[.digits][(e|E)[+-]digits] into value. Digits past the
+// precision of value are rounded half away from zero. On error value is
+// unchanged and ec is invalid_argument (no number) or result_out_of_range,
+// which includes raw values needing more than 19 significant digits.
+template<unsigned char E, typename IntegerT>
+from_chars_result from_chars(
+        const char* first, const char* last,
+        fixed_decimal<E, IntegerT>& value) noexcept
+{
+    static_assert(sizeof(IntegerT) <= 8, "Integer type is too wide.");
+    using details::is_digit;
+
+    const char* p = first;
+    bool negative = false;
+    if (p != last and (*p == '-' or *p == '+'))
+        negative = (*p++ == '-');
+
+    details::decimal_digits digits;
+    p = digits.parse_run(p, last, false);
+    if (p != last and *p == '.')
+        p = digits.parse_run(p + 1, last, true);
+    if (not digits.any_digit)
+        return {first, std::errc::invalid_argument};
+
+    if (p != last and (*p == 'e' or *p == 'E')) {
+        const char* q = p + 1;
+        bool exp_negative = false;
+        if (q != last and (*q == '-' or *q == '+'))
+            exp_negative = (*q++ == '-');
+        if (q != last and is_digit(*q)) {
+            int exp = 0;
+            for (; q != last and is_digit(*q); ++q) {
+                if (exp < 100000)
+                    exp = exp * 10 + (*q - '0');
+            }
+            digits.scale += exp_negative ? -exp : exp;
+            p = q;
+        }
+    }
+
+    // Scale the mantissa so that one unit is 10^-E.
+    const int shift = digits.scale + E;
+    std::uint64_t magnitude = digits.mantissa;
+    if (shift > 0 and magnitude != 0) {
+        // A dropped digit at or above one unit means over 19 digits.
+        if (shift > 19 or digits.first_dropped != 0 or
+                magnitude > std::numeric_limits<std::uint64_t>::max() /
+                    details::pow10<std::uint64_t>(shift))
+            return {p, std::errc::result_out_of_range};
+        magnitude *= details::pow10<std::uint64_t>(shift);
+    } else if (shift == 0) {
+        magnitude += (digits.first_dropped >= '5');
+    } else if (shift < 0) {
+        magnitude = details::scale_down<rounding::half_up>(
+                magnitude, static_cast<unsigned>(-shift));
+    }
+
+    using unsigned_type = std::make_unsigned_t<IntegerT>;
+    const std::uint64_t max = static_cast<unsigned_type>(
+            std::numeric_limits<IntegerT>::max());
+    const std::uint64_t limit = (negative and std::is_signed<IntegerT>::value) ?
+        max + 1 : (negative ? 0 : max);
+    if (magnitude > limit)
+        return {p, std::errc::result_out_of_range};
+
+    const auto raw = static_cast<unsigned_type>(magnitude);
+    value = fixed_decimal<E, IntegerT>::from_raw_value(
+            static_cast<IntegerT>(negative ? unsigned_type(0) - raw : raw));
+    return {p, std::errc{}};
+}
+
+// Formats value as [-]digits[.digits] into [first, last). On error the
+// range is untouched and ec is value_too_large.
+template<unsigned char E, typename IntegerT>
+to_chars_result to_chars(
+        char* first, char* last,
+        const fixed_decimal<E, IntegerT>& value,
+        trailing_zeros zeros = trailing_zeros::keep) noexcept
+{
+    static_assert(sizeof(IntegerT) <= 8, "Integer type is too wide.");
+    const IntegerT raw = value.raw_value();
+    const bool negative = raw < IntegerT(0);
+    const std::uint64_t magnitude = negative ?
+        std::uint64_t(0) - static_cast<std::uint64_t>(raw) :
+        static_cast<std::uint64_t>(raw);
+    return details::write_decimal(first, last, negative, magnitude, E, zeros);
+}
+
+// Formats value as [-]digits into [first, last). On error the range is
+// untouched and ec is value_too_large.
+template<typename IntegerT, details::enable_if_number_t<IntegerT> = 0>
+to_chars_result to_chars(char* first, char* last, IntegerT value) noexcept
+{
+    // Widened first so that short types are not promoted to int.
+    const bool negative = value < IntegerT(0);
+    const std::uint64_t magnitude = negative ?
+        std::uint64_t(0) - static_cast<std::uint64_t>(value) :
+        static_cast<std::uint64_t>(value);
+    return details::write_decimal(
+            first, last, negative, magnitude, 0, trailing_zeros::keep);
+}
+
+// Formats value with places decimal places, as printf's "%.*f" would but
+// without a negative zero. The exact binary value is rounded half to even.
+// Returns invalid_argument for NaN, infinity or more than 17 places, and
+// value_too_large if the output does not fit; the range is untouched then.
+inline
+to_chars_result to_chars(
+        char* first, char* last, double value, unsigned places = 6,
+        trailing_zeros zeros = trailing_zeros::keep) noexcept
+{
+    if (places > details::max_double_places or not std::isfinite(value))
+        return {last, std::errc::invalid_argument};
+
+    std::int64_t raw;
+    if (details::double_to_places(value, places, raw,
+                std::make_integer_sequence<
+                    unsigned char, details::max_double_places + 1>{}) ==
+            std::errc{})
+    {
+        const bool negative = raw < 0;
+        const std::uint64_t magnitude = negative ?
+            std::uint64_t(0) - static_cast<std::uint64_t>(raw) :
+            static_cast<std::uint64_t>(raw);
+        return details::write_decimal(
+                first, last, negative, magnitude, places, zeros);
+    }
+
+    // Past 19 digits, which printf handles exactly without allocating.
+    char buffer[std::numeric_limits<double>::max_exponent10 +
+        details::max_double_places + 4];
+    int length = std::snprintf(buffer, sizeof(buffer), "%.*f",
+            static_cast<int>(places), value);
+    if (zeros == trailing_zeros::trim and places != 0) {
+        while (buffer[length - 1] == '0')
+            --length;
+        length -= (buffer[length - 1] == '.');
+    }
+    if (last - first < length)
+        return {last, std::errc::value_too_large};
+    std::memcpy(first, buffer, static_cast<std::size_t>(length));
+    return {first + length, std::errc{}};
+}
+
+} // namespace ash
@@ -0,0 +1,443 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "fixed_decimal.h"
+#include "span.h"
+
+namespace ash {
+
+namespace details {
+
+inline
+std::uint64_t load_le64(const unsigned char* p) noexcept
+{
+    std::uint64_t v;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(&v, p, sizeof(v));
+#else
+    v = 0;
+    for (int i = 7; i >= 0; --i)
+        v = (v << 8) | p[i];
+#endif
+    return v;
+}
+
+inline
+void store_le64(unsigned char* p, std::uint64_t v) noexcept
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(p, &v, sizeof(v));
+#else
+    for (int i = 0; i != 8; ++i, v >>= 8)
+        p[i] = static_cast<unsigned char>(v);
+#endif
+}
+
+constexpr
+std::uint64_t zigzag(std::uint64_t v) noexcept
+{
+    return (v << 1) ^ (std::uint64_t(0) - (v >> 63));
+}
+
+constexpr
+std::uint64_t unzigzag(std::uint64_t z) noexcept
+{
+    return (z >> 1) ^ (std::uint64_t(0) - (z & 1));
+}
+
+constexpr
+std::uint64_t low_mask(unsigned width) noexcept
+{
+    return (width == 64) ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+}
+
+inline
+unsigned bit_width(std::uint64_t v) noexcept
+{
+    return v == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(v));
+}
+
+// Packs n values of width bits each into out, which must hold
+// (n * width + 7) / 8 + 8 bytes. Bits are accumulated in a word and
+// stored eight bytes at a time.
+inline
+void pack_bits(
+        const std::uint64_t* z, std::size_t n, unsigned width,
+        unsigned char* out) noexcept
+{
+    std::uint64_t acc = 0;
+    unsigned used = 0;
+    for (std::size_t j = 0; j != n; ++j) {
+        acc |= z[j] << used;
+        used += width;
+        if (used >= 64) {
+            store_le64(out, acc);
+            out += 8;
+            used -= 64;
+            acc = (used == 0) ? 0 : z[j] >> (width - used);
+        }
+    }
+    store_le64(out, acc);
+}
+
+// out[j] = prev + sum of the first j + 1 unpacked deltas. in must be
+// readable for 9 bytes past the packed bits.
+inline
+void unpack_deltas(
+        const unsigned char* in, std::size_t n, unsigned width,
+        std::uint64_t prev, std::uint64_t* out) noexcept
+{
+    const std::uint64_t mask = low_mask(width);
+    std::size_t j = 0;
+#if defined(__AVX2__)
+    if (width <= 56) {
+        const __m256i vmask = _mm256_set1_epi64x(static_cast<long long>(mask));
+        const __m256i seven = _mm256_set1_epi64x(7);
+        const __m256i one = _mm256_set1_epi64x(1);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i step = _mm256_set1_epi64x(4 * width);
+        __m256i bits = _mm256_setr_epi64x(0, width, 2 * width, 3 * width);
+        __m256i carry = _mm256_set1_epi64x(static_cast<long long>(prev));
+        for (; j + 4 <= n; j += 4) {
+            const __m256i words = _mm256_i64gather_epi64(
+                    reinterpret_cast<const long long*>(in),
+                    _mm256_srli_epi64(bits, 3), 1);
+            const __m256i z = _mm256_and_si256(
+                    _mm256_srlv_epi64(words, _mm256_and_si256(bits, seven)),
+                    vmask);
+            __m256i d = _mm256_xor_si256(
+                    _mm256_srli_epi64(z, 1),
+                    _mm256_sub_epi64(zero, _mm256_and_si256(z, one)));
+            // Inclusive prefix sum across the four lanes.
+            d = _mm256_add_epi64(d, _mm256_blend_epi32(
+                        _mm256_permute4x64_epi64(d, 0x90), zero, 0x03));
+            d = _mm256_add_epi64(d, _mm256_permute2x128_si256(d, d, 0x08));
+            d = _mm256_add_epi64(d, carry);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j), d);
+            carry = _mm256_permute4x64_epi64(d, 0xFF);
+            bits = _mm256_add_epi64(bits, step);
+        }
+        if (j != 0)
+            prev = out[j - 1];
+    }
+#endif
+    for (; j != n; ++j) {
+        const std::size_t bit = j * width;
+        const unsigned shift = bit % 8;
+        const unsigned char* p = in + bit / 8;
+        std::uint64_t z = load_le64(p) >> shift;
+        if (shift + width > 64)
+            z |= std::uint64_t(p[8]) << (64 - shift);
+        prev += unzigzag(z & mask);
+        out[j] = prev;
+    }
+}
+
+inline
+void put_varint(std::vector<std::uint8_t>& out, std::uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+inline
+const std::uint8_t* get_varint(
+        const std::uint8_t* p, const std::uint8_t* last, std::uint64_t& v)
+{
+    v = 0;
+    for (unsigned shift = 0; p != last and shift < 64; shift += 7) {
+        const std::uint8_t byte = *p++;
+        v |= std::uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return p;
+    }
+    throw std::runtime_error("Corrupt decimal block varint.");
+}
+
+} // namespace details
+
+// Compressed encoding of fixed_decimal sequences. Values are grouped into
+// blocks of up to block_size:
+//
+//   u8 count | u8 width | varint zigzag(first) | (count - 1) deltas
+//
+// where deltas between consecutive raw values are zigzag encoded and bit
+// packed with width bits each. Blocks are self-contained, so any block can
+// be decoded given its offset.
+struct decimal_codec
+{
+    static const constexpr std::size_t block_size = 128;
+    static const constexpr std::size_t max_packed_bytes = (block_size - 1) * 8;
+};
+
+// Appends encoded blocks to a byte buffer. Values are buffered until a
+// block fills; call flush() to write a final partial block.
+template<unsigned char E, typename IntegerT = long long>
+class decimal_encoder
+{
+public:
+    using value_type = fixed_decimal<E, IntegerT>;
+    using size_type = std::size_t;
+
+    static_assert(sizeof(IntegerT) <= 8, "Integer type is too wide.");
+
+public:
+    explicit decimal_encoder(std::vector<std::uint8_t>& out) :
+        out_{&out}
+    { }
+
+    void append(value_type value)
+    {
+        pending_[pending_size_++] =
+            static_cast<std::uint64_t>(value.raw_value());
+        if (pending_size_ == decimal_codec::block_size)
+            flush();
+    }
+
+    void append(span<const value_type> values)
+    {
+        auto first = values.begin();
+        const auto last = values.end();
+        while (first != last) {
+            const auto count = std::min<size_type>(
+                decimal_codec::block_size - pending_size_,
+                static_cast<size_type>(last - first));
+            for (size_type i = 0; i != count; ++i, ++first) {
+                pending_[pending_size_ + i] =
+                    static_cast<std::uint64_t>(first->raw_value());
+            }
+            pending_size_ += count;
+            if (pending_size_ == decimal_codec::block_size)
+                flush();
+        }
+    }
+
+    // Writes buffered values as a block, if any.
+    void flush()
+    {
+        if (pending_size_ == 0)
+            return;
+        encode_block(pending_, pending_size_, *out_);
+        blocks_ += 1;
+        size_ += pending_size_;
+        pending_size_ = 0;
+    }
+
+    // Values written to the buffer, excluding those not yet flushed.
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    size_type block_count() const noexcept
+    {
+        return blocks_;
+    }
+
+private:
+    static
+    void encode_block(
+            const std::uint64_t* raw, std::size_t n,
+            std::vector<std::uint8_t>& out)
+    {
+        std::uint64_t z[decimal_codec::block_size];
+        std::uint64_t all = 0;
+        for (std::size_t i = 1; i != n; ++i) {
+            z[i - 1] = details::zigzag(raw[i] - raw[i - 1]);
+            all |= z[i - 1];
+        }
+        const unsigned width = details::bit_width(all);
+
+        out.push_back(static_cast<std::uint8_t>(n));
+        out.push_back(static_cast<std::uint8_t>(width));
+        details::put_varint(out, details::zigzag(raw[0]));
+
+        // Pack in place, then trim the padding pack_bits writes into.
+        const auto start = out.size();
+        const std::size_t bytes = ((n - 1) * width + 7) / 8;
+        out.resize(start + bytes + 8);
+        details::pack_bits(z, n - 1, width, out.data() + start);
+        out.resize(start + bytes);
+    }
+
+    std::vector<std::uint8_t>* out_;
+    std::uint64_t pending_[decimal_codec::block_size];
+    size_type pending_size_{0};
+    size_type size_{0};
+    size_type blocks_{0};
+};
+
+// Decodes a buffer written by decimal_encoder, block by block or by index.
+// Malformed input throws std::runtime_error.
+template<unsigned char E, typename IntegerT = long long>
+class decimal_decoder
+{
+public:
+    using value_type = fixed_decimal<E, IntegerT>;
+    using size_type = std::size_t;
+
+    static_assert(sizeof(IntegerT) <= 8, "Integer type is too wide.");
+
+public:
+    explicit decimal_decoder(span<const std::uint8_t> bytes) :
+        bytes_{bytes},
+        pos_{bytes.data()}
+    { }
+
+    // Decodes the next block into out, which must hold block_size values.
+    // Returns the number of values decoded, zero at the end.
+    size_type next(span<value_type> out)
+    {
+        assert(out.size() >= decimal_codec::block_size);
+        if (pos_ == bytes_.end())
+            return 0;
+        std::uint64_t raw[decimal_codec::block_size];
+        const auto n = decode(pos_, raw);
+        for (size_type i = 0; i != n; ++i) {
+            out[i] = value_type::from_raw_value(static_cast<IntegerT>(raw[i]));
+        }
+        return n;
+    }
+
+    // Restarts next() from the given block.
+    void seek(size_type block)
+    {
+        build_index();
+        assert(block <= offsets_.size());
+        pos_ = (block == offsets_.size()) ?
+            bytes_.end() : bytes_.data() + offsets_[block];
+    }
+
+    size_type block_count()
+    {
+        build_index();
+        return offsets_.size();
+    }
+
+    // Total number of encoded values.
+    size_type size()
+    {
+        build_index();
+        return total_;
+    }
+
+    // Decodes block k into out, returns its number of values.
+    size_type decode_block(size_type k, span<value_type> out)
+    {
+        build_index();
+        assert(k < offsets_.size());
+        const auto* saved = pos_;
+        pos_ = bytes_.data() + offsets_[k];
+        const auto n = next(out);
+        pos_ = saved;
+        return n;
+    }
+
+    // Value at index i, decoding only the block that holds it.
+    value_type at(size_type i)
+    {
+        build_index();
+        if (i >= total_)
+            throw std::out_of_range("decimal_decoder::at");
+        const auto k = static_cast<size_type>(std::upper_bound(
+                    firsts_.begin(), firsts_.end(), i) - firsts_.begin()) - 1;
+        value_type block[decimal_codec::block_size];
+        decode_block(k, make_span(block, decimal_codec::block_size));
+        return block[i - firsts_[k]];
+    }
+
+private:
+    struct header
+    {
+        size_type count;
+        unsigned width;
+        std::uint64_t first;
+        const std::uint8_t* packed;
+        size_type packed_bytes;
+    };
+
+    header read_header(const std::uint8_t* p) const
+    {
+        const auto* last = bytes_.end();
+        if (last - p < 2)
+            throw std::runtime_error("Truncated decimal block.");
+        header h;
+        h.count = p[0];
+        h.width = p[1];
+        if (h.count == 0 or h.count > decimal_codec::block_size or h.width > 64)
+            throw std::runtime_error("Corrupt decimal block header.");
+        h.packed = details::get_varint(p + 2, last, h.first);
+        h.packed_bytes = ((h.count - 1) * h.width + 7) / 8;
+        if (static_cast<size_type>(last - h.packed) < h.packed_bytes)
+            throw std::runtime_error("Truncated decimal block.");
+        return h;
+    }
+
+    size_type decode(const std::uint8_t*& p, std::uint64_t* raw) const
+    {
+        const header h = read_header(p);
+        // Copy to a padded buffer so unpacking may read whole words.
+        unsigned char packed[decimal_codec::max_packed_bytes + 16];
+        std::memcpy(packed, h.packed, h.packed_bytes);
+        std::memset(packed + h.packed_bytes, 0, 16);
+        raw[0] = details::unzigzag(h.first);
+        details::unpack_deltas(packed, h.count - 1, h.width, raw[0], raw + 1);
+        p = h.packed + h.packed_bytes;
+        return h.count;
+    }
+
+    void build_index()
+    {
+        if (indexed_)
+            return;
+        for (const auto* p = bytes_.data(); p != bytes_.end();) {
+            const header h = read_header(p);
+            offsets_.push_back(static_cast<size_type>(p - bytes_.data()));
+            firsts_.push_back(total_);
+            total_ += h.count;
+            p = h.packed + h.packed_bytes;
+        }
+        indexed_ = true;
+    }
+
+    span<const std::uint8_t> bytes_;
+    const std::uint8_t* pos_;
+    bool indexed_{false};
+    size_type total_{0};
+    std::vector<size_type> offsets_;
+    std::vector<size_type> firsts_;
+};
+
+} // namespace ash
@@ -0,0 +1,455 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "block_runner.h"
+#include "decimal_kernels.h"
+#include "fixed_decimal.h"
+#include "page_alloc.h"
+#include "span.h"
+
+namespace ash {
+
+namespace details {
+
+// Exact sum of x. Values are split into halves whose sums cannot overflow
+// within a block, which keeps the loop in native lanes so it vectorizes.
+template<typename IntegerT>
+wide_integer_t<IntegerT> wide_sum(const IntegerT* x, std::size_t n) noexcept
+{
+    using W = wide_integer_t<IntegerT>;
+#if defined(__SIZEOF_INT128__)
+    using U = std::make_unsigned_t<IntegerT>;
+    constexpr unsigned bits = sizeof(IntegerT) * 8;
+    constexpr unsigned half = bits / 2;
+    constexpr U low_mask = (U(1) << half) - 1;
+    constexpr std::size_t block = std::size_t(1) << (half - 1);
+
+    W total = 0;
+    while (n != 0) {
+        const std::size_t m = std::min(n, block);
+        U lo = 0, hi = 0, neg = 0;
+        for (std::size_t i = 0; i != m; ++i) {
+            const U v = static_cast<U>(x[i]);
+            lo += v & low_mask;
+            hi += v >> half;
+            neg += v >> (bits - 1);
+        }
+        total += W(lo) + (W(hi) << half);
+        if (std::is_signed<IntegerT>::value)
+            total -= W(neg) << bits;
+        x += m;
+        n -= m;
+    }
+    return total;
+#else
+    W total = 0;
+    for (std::size_t i = 0; i != n; ++i)
+        total += x[i];
+    return total;
+#endif
+}
+
+// Exact sum of x[i] * y[i].
+template<typename IntegerT>
+wide_integer_t<IntegerT> wide_dot(
+        const IntegerT* x, const IntegerT* y, std::size_t n) noexcept
+{
+    using W = wide_integer_t<IntegerT>;
+    W total = 0;
+    for (std::size_t i = 0; i != n; ++i)
+        total += W(x[i]) * y[i];
+    return total;
+}
+
+} // namespace details
+
+// Read-only view of contiguous fixed_decimal values with exact, optionally
+// parallel, aggregations. Sums are accumulated in 128 bits where available.
+template<unsigned char E, typename IntegerT = long long>
+class decimal_column_view
+{
+public:
+    using value_type = fixed_decimal<E, IntegerT>;
+    using raw_type = IntegerT;
+    using wide_type = details::wide_integer_t<IntegerT>;
+    using size_type = std::size_t;
+    using const_pointer = const value_type*;
+    using const_iterator = const_pointer;
+
+    static const constexpr size_type npos = static_cast<size_type>(-1);
+
+public:
+    constexpr decimal_column_view() = default;
+
+    constexpr decimal_column_view(const_pointer data, size_type size) :
+        data_{data},
+        size_{size}
+    { }
+
+    constexpr decimal_column_view(span<const value_type> values) :
+        data_{values.data()},
+        size_{values.size()}
+    { }
+
+    constexpr const_pointer data() const    { return data_; }
+    constexpr size_type size() const        { return size_; }
+    constexpr bool empty() const            { return size_ == 0; }
+    constexpr const_iterator begin() const  { return data_; }
+    constexpr const_iterator end() const    { return data_ + size_; }
+
+    constexpr value_type operator[](size_type i) const
+    {
+        return data_[i];
+    }
+
+    span<const value_type> values() const
+    {
+        return {data_, size_};
+    }
+
+    const raw_type* raw() const
+    {
+        static_assert(
+                sizeof(value_type) == sizeof(raw_type) and
+                std::is_standard_layout<value_type>::value,
+                "fixed_decimal must be layout compatible with its integer.");
+        return reinterpret_cast<const raw_type*>(data_);
+    }
+
+    decimal_column_view slice(size_type pos, size_type count = npos) const
+    {
+        assert(pos <= size_);
+        return {data_ + pos, std::min(count, size_ - pos)};
+    }
+
+    //
+    // Aggregations. Each splits the work over at most n_threads threads,
+    // keeping at least details::block_runner::min_block values per thread.
+    //
+
+    // Exact sum in units of 10^-E.
+    wide_type sum_raw(
+            unsigned n_threads = std::thread::hardware_concurrency()) const
+    {
+        const details::block_runner run{size_, n_threads};
+        std::vector<wide_type> partial(run.blocks());
+        run([&](size_type b, size_type first, size_type last) {
+            partial[b] = details::wide_sum(raw() + first, last - first);
+        });
+        wide_type total = 0;
+        for (auto p : partial)
+            total += p;
+        return total;
+    }
+
+    template<class Policy = overflow::checked>
+    value_type sum(
+            unsigned n_threads = std::thread::hardware_concurrency()) const
+    {
+        return value_type::from_raw_value(
+                details::narrow<Policy, IntegerT>(sum_raw(n_threads)));
+    }
+
+    // Smallest value, the view must not be empty.
+    value_type min(
+            unsigned n_threads = std::thread::hardware_concurrency()) const
+    {
+        return reduce(n_threads, [](span<const value_type> xs) {
+            return decimal::min(xs);
+        }, [](value_type a, value_type b) { return std::min(a, b); });
+    }
+
+    // Largest value, the view must not be empty.
+    value_type max(
+            unsigned n_threads = std::thread::hardware_concurrency()) const
+    {
+        return reduce(n_threads, [](span<const value_type> xs) {
+            return decimal::max(xs);
+        }, [](value_type a, value_type b) { return std::max(a, b); });
+    }
+
+    // Volume weighted average of this view as prices, zero without volume.
+    template<class Rounding = rounding::truncate, unsigned char F>
+    value_type vwap(
+            const decimal_column_view<F, IntegerT>& volume,
+            unsigned n_threads = std::thread::hardware_concurrency()) const
+    {
+        assert(volume.size() == size_);
+        const details::block_runner run{size_, n_threads};
+        std::vector<wide_type> notional(run.blocks());
+        std::vector<wide_type> total(run.blocks());
+        run([&](size_type b, size_type first, size_type last) {
+            notional[b] = details::wide_dot(
+                    raw() + first, volume.raw() + first, last - first);
+            total[b] = details::wide_sum(volume.raw() + first, last - first);
+        });
+        wide_type num = 0, den = 0;
+        for (size_type b = 0; b != run.blocks(); ++b) {
+            num += notional[b];
+            den += total[b];
+        }
+        if (den == 0)
+            return value_type{};
+        return value_type::from_raw_value(static_cast<IntegerT>(
+                    details::div_round<Rounding>(num, den)));
+    }
+
+    // out[i] = sum of the first i + 1 values. out must hold size() values.
+    template<class Policy = overflow::checked>
+    void prefix_sum(
+            span<value_type> out,
+            unsigned n_threads = std::thread::hardware_concurrency()) const
+    {
+        assert(out.size() >= size_);
+        const details::block_runner run{size_, n_threads};
+        std::vector<wide_type> offset(run.blocks() + 1);
+        if (run.blocks() > 1) {
+            run([&](size_type b, size_type first, size_type last) {
+                offset[b + 1] = details::wide_sum(raw() + first, last - first);
+            });
+            for (size_type b = 1; b <= run.blocks(); ++b)
+                offset[b] += offset[b - 1];
+        }
+        run([&](size_type b, size_type first, size_type last) {
+            wide_type total = offset[b];
+            for (size_type i = first; i != last; ++i) {
+                total += raw()[i];
+                out[i] = value_type::from_raw_value(
+                        details::narrow<Policy, IntegerT>(total));
+            }
+        });
+    }
+
+    // out[i] = sum of values [i, i + window). Returns the number of sums,
+    // size() - window + 1, which out must hold.
+    template<class Policy = overflow::checked>
+    size_type rolling_sum(
+            size_type window, span<value_type> out,
+            unsigned n_threads = std::thread::hardware_concurrency()) const
+    {
+        return rolling(window, out, n_threads, [](wide_type s, size_type) {
+            return details::narrow<Policy, IntegerT>(s);
+        });
+    }
+
+    // out[i] = mean of values [i, i + window), rounded by Rounding.
+    template<class Rounding = rounding::truncate>
+    size_type rolling_mean(
+            size_type window, span<value_type> out,
+            unsigned n_threads = std::thread::hardware_concurrency()) const
+    {
+        return rolling(window, out, n_threads, [](wide_type s, size_type w) {
+            return static_cast<IntegerT>(
+                    details::div_round<Rounding>(s, wide_type(w)));
+        });
+    }
+
+private:
+    template<typename Block, typename Combine>
+    value_type reduce(unsigned n_threads, Block block, Combine combine) const
+    {
+        assert(not empty());
+        const details::block_runner run{size_, n_threads};
+        std::vector<value_type> partial(run.blocks());
+        run([&](size_type b, size_type first, size_type last) {
+            partial[b] = block(values().subspan(first, last - first));
+        });
+        value_type result = partial[0];
+        for (auto p : partial)
+            result = combine(result, p);
+        return result;
+    }
+
+    template<typename Finish>
+    size_type rolling(
+            size_type window, span<value_type> out,
+            unsigned n_threads, Finish finish) const
+    {
+        assert(window != 0);
+        if (window > size_)
+            return 0;
+        const size_type count = size_ - window + 1;
+        assert(out.size() >= count);
+        const raw_type* x = raw();
+        details::block_runner{count, n_threads}(
+            [&](size_type, size_type first, size_type last) {
+                wide_type s = details::wide_sum(x + first, window);
+                for (size_type i = first; i != last; ++i) {
+                    out[i] = value_type::from_raw_value(finish(s, window));
+                    if (i + window != size_)
+                        s += wide_type(x[i + window]) - x[i];
+                }
+            });
+        return count;
+    }
+
+protected:
+    const_pointer data_{nullptr};
+    size_type size_{0};
+};
+
+// Owning, append-only series of fixed_decimal values in one cache line
+// aligned block. Converts to decimal_column_view for its aggregations.
+template<unsigned char E, typename IntegerT = long long>
+class decimal_column : public decimal_column_view<E, IntegerT>
+{
+private:
+    using base_type = decimal_column_view<E, IntegerT>;
+
+public:
+    using typename base_type::value_type;
+    using typename base_type::size_type;
+    using pointer = value_type*;
+
+    static const constexpr std::size_t alignment = 64;
+
+public:
+    decimal_column() = default;
+
+    explicit decimal_column(span<const value_type> values)
+    {
+        append(values);
+    }
+
+    decimal_column(const decimal_column& src) :
+        decimal_column(src.values())
+    { }
+
+    decimal_column(decimal_column&& src) noexcept
+    {
+        swap(src);
+    }
+
+    ~decimal_column()
+    {
+        release();
+    }
+
+    decimal_column& operator=(decimal_column src) noexcept
+    {
+        swap(src);
+        return *this;
+    }
+
+    void swap(decimal_column& other) noexcept
+    {
+        std::swap(this->data_, other.data_);
+        std::swap(this->size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    size_type capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    void reserve(size_type n)
+    {
+        if (n <= capacity_)
+            return;
+        adopt(relocated(n), n);
+    }
+
+    void append(value_type value)
+    {
+        if (this->size_ == capacity_)
+            reserve(std::max<size_type>(initial_capacity(), capacity_ * 2));
+        mutable_data()[this->size_++] = value;
+    }
+
+    void append_raw(IntegerT raw)
+    {
+        append(value_type::from_raw_value(raw));
+    }
+
+    // values may view this column itself, so on growth the old block is
+    // only freed once they are copied.
+    void append(span<const value_type> values)
+    {
+        const size_type n = this->size_ + values.size();
+        if (n > capacity_) {
+            const size_type cap = std::max(n, capacity_ * 2);
+            pointer fresh = relocated(cap);
+            std::copy(values.begin(), values.end(), fresh + this->size_);
+            adopt(fresh, cap);
+        } else {
+            std::copy(values.begin(), values.end(), mutable_data() + this->size_);
+        }
+        this->size_ = n;
+    }
+
+    void clear() noexcept
+    {
+        this->size_ = 0;
+    }
+
+    base_type view() const noexcept
+    {
+        return *this;
+    }
+
+private:
+    static constexpr
+    size_type initial_capacity()
+    {
+        return alignment / sizeof(value_type) * 16;
+    }
+
+    pointer mutable_data() noexcept
+    {
+        return const_cast<pointer>(this->data_);
+    }
+
+    // A block of n values holding a copy of the current ones.
+    pointer relocated(size_type n) const
+    {
+        auto* fresh = static_cast<pointer>(heap_alloc{}.allocate(
+                    n * sizeof(value_type), alignment));
+        std::copy(this->data_, this->data_ + this->size_, fresh);
+        return fresh;
+    }
+
+    void adopt(pointer fresh, size_type n) noexcept
+    {
+        release();
+        this->data_ = fresh;
+        capacity_ = n;
+    }
+
+    void release() noexcept
+    {
+        if (this->data_ != nullptr) {
+            heap_alloc{}.deallocate(
+                    mutable_data(), capacity_ * sizeof(value_type), alignment);
+        }
+    }
+
+    size_type capacity_{0};
+};
+
+} // namespace ash
@@ -0,0 +1,475 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#define ASH_DECIMAL_SIMD 1
+#else
+#define ASH_DECIMAL_SIMD 0
+#endif
+
+#include "fixed_decimal.h"
+#include "span.h"
+
+namespace ash {
+
+namespace decimal {
+
+namespace details {
+
+template<class T>
+struct is_fixed_decimal : std::false_type { };
+
+template<unsigned char E, typename IntegerT>
+struct is_fixed_decimal<fixed_decimal<E, IntegerT>> : std::true_type { };
+
+template<class D>
+using decimal_t = std::remove_const_t<D>;
+
+template<class D>
+using raw_t = typename decimal_t<D>::value_type;
+
+template<class D>
+const raw_t<D>* raw(span<D> xs) noexcept
+{
+    static_assert(is_fixed_decimal<decimal_t<D>>::value, "Not a fixed_decimal.");
+    static_assert(
+            sizeof(decimal_t<D>) == sizeof(raw_t<D>) and
+            std::is_standard_layout<decimal_t<D>>::value,
+            "fixed_decimal must be layout compatible with its integer.");
+    return reinterpret_cast<const raw_t<D>*>(xs.data());
+}
+
+template<class D>
+raw_t<D>* raw_out(span<D> xs) noexcept
+{
+    static_assert(not std::is_const<D>::value, "Output span is const.");
+    return const_cast<raw_t<D>*>(raw(xs));
+}
+
+#if ASH_DECIMAL_SIMD
+
+// Lanes of signed 64 bit integers in the widest available register.
+struct i64v
+{
+#if defined(__AVX2__)
+    using reg = __m256i;
+    static const constexpr std::size_t lanes = 4;
+
+    static reg load(const void* p)  { return _mm256_loadu_si256(static_cast<const reg*>(p)); }
+    static void store(void* p, reg v) { _mm256_storeu_si256(static_cast<reg*>(p), v); }
+    static reg zero()               { return _mm256_setzero_si256(); }
+    static reg set1(long long x)    { return _mm256_set1_epi64x(x); }
+    static reg add(reg a, reg b)    { return _mm256_add_epi64(a, b); }
+    static reg gt(reg a, reg b)     { return _mm256_cmpgt_epi64(a, b); }
+    static reg blend(reg a, reg b, reg m) { return _mm256_blendv_epi8(a, b, m); }
+
+    static reg mul(reg a, reg b)
+    {
+#if defined(__AVX512DQ__) && defined(__AVX512VL__)
+        return _mm256_mullo_epi64(a, b);
+#else
+        const reg lo = _mm256_mul_epu32(a, b);
+        const reg cross = _mm256_add_epi64(
+                _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+#endif
+    }
+#else
+    using reg = __m128i;
+    static const constexpr std::size_t lanes = 2;
+
+    static reg load(const void* p)  { return _mm_loadu_si128(static_cast<const reg*>(p)); }
+    static void store(void* p, reg v) { _mm_storeu_si128(static_cast<reg*>(p), v); }
+    static reg zero()               { return _mm_setzero_si128(); }
+    static reg set1(long long x)    { return _mm_set1_epi64x(x); }
+    static reg add(reg a, reg b)    { return _mm_add_epi64(a, b); }
+    static reg gt(reg a, reg b)     { return _mm_cmpgt_epi64(a, b); }
+    static reg blend(reg a, reg b, reg m) { return _mm_blendv_epi8(a, b, m); }
+
+    static reg mul(reg a, reg b)
+    {
+        const reg lo = _mm_mul_epu32(a, b);
+        const reg cross = _mm_add_epi64(
+                _mm_mul_epu32(_mm_srli_epi64(a, 32), b),
+                _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+        return _mm_add_epi64(lo, _mm_slli_epi64(cross, 32));
+    }
+#endif
+
+    static reg min(reg a, reg b)    { return blend(a, b, gt(a, b)); }
+    static reg max(reg a, reg b)    { return blend(b, a, gt(a, b)); }
+
+    template<typename Op>
+    static long long reduce(reg v, Op op)
+    {
+        alignas(sizeof(reg)) long long x[lanes];
+        store(x, v);
+        long long r = x[0];
+        for (std::size_t i = 1; i != lanes; ++i)
+            r = op(r, x[i]);
+        return r;
+    }
+};
+
+#endif // ASH_DECIMAL_SIMD
+
+// Whether 64 bit lane arithmetic applies to raw values of type I. Additions
+// and products wrap identically for signed and unsigned integers.
+template<typename I>
+using simd_arith = std::integral_constant<bool,
+      ASH_DECIMAL_SIMD and std::is_integral<I>::value and sizeof(I) == 8>;
+
+template<typename I>
+using simd_signed = std::integral_constant<bool,
+      simd_arith<I>::value and std::is_signed<I>::value>;
+
+template<typename I>
+I sum(const I* x, std::size_t n, std::false_type)
+{
+    I total{0};
+    for (std::size_t i = 0; i != n; ++i)
+        total += x[i];
+    return total;
+}
+
+template<typename I>
+void scale(const I* x, I k, I* out, std::size_t n, std::false_type)
+{
+    for (std::size_t i = 0; i != n; ++i)
+        out[i] = x[i] * k;
+}
+
+struct min_op
+{
+    template<typename I>
+    I operator()(I a, I b) const { return (b < a) ? b : a; }
+#if ASH_DECIMAL_SIMD
+    i64v::reg operator()(i64v::reg a, i64v::reg b) const { return i64v::min(a, b); }
+#endif
+};
+
+struct max_op
+{
+    template<typename I>
+    I operator()(I a, I b) const { return (a < b) ? b : a; }
+#if ASH_DECIMAL_SIMD
+    i64v::reg operator()(i64v::reg a, i64v::reg b) const { return i64v::max(a, b); }
+#endif
+};
+
+template<typename I, typename Op>
+I reduce(const I* x, std::size_t n, Op op, std::false_type)
+{
+    I r = *x;
+    for (const I* p = x + 1; p < x + n; ++p)
+        r = op(r, *p);
+    return r;
+}
+
+#if ASH_DECIMAL_SIMD
+
+template<typename I>
+I sum(const I* x, std::size_t n, std::true_type)
+{
+    using v = i64v;
+    std::size_t i = 0;
+    auto acc = v::zero();
+    for (; i + v::lanes <= n; i += v::lanes)
+        acc = v::add(acc, v::load(x + i));
+    auto total = static_cast<I>(v::reduce(acc, [](long long a, long long b) {
+        return static_cast<long long>(
+            static_cast<unsigned long long>(a) + static_cast<unsigned long long>(b));
+    }));
+    for (; i != n; ++i)
+        total += x[i];
+    return total;
+}
+
+template<typename I>
+void scale(const I* x, I k, I* out, std::size_t n, std::true_type)
+{
+    using v = i64v;
+    std::size_t i = 0;
+    const auto vk = v::set1(static_cast<long long>(k));
+    for (; i + v::lanes <= n; i += v::lanes)
+        v::store(out + i, v::mul(v::load(x + i), vk));
+    for (; i != n; ++i)
+        out[i] = x[i] * k;
+}
+
+template<typename I, typename Op>
+I reduce(const I* x, std::size_t n, Op op, std::true_type)
+{
+    using v = i64v;
+    // Every lane starts at x[0], which min and max may see twice.
+    const I* last = x + n;
+    const I* p = x;
+    auto acc = v::set1(static_cast<long long>(*x));
+    for (; last - p >= std::ptrdiff_t(v::lanes); p += v::lanes)
+        acc = op(acc, v::load(p));
+    I r = static_cast<I>(v::reduce(acc, op));
+    for (; p < last; ++p)
+        r = op(r, *p);
+    return r;
+}
+
+inline
+void to_double(const long long* x, double* out, std::size_t n, double m)
+{
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256d vm = _mm256_set1_pd(m);
+#if defined(__AVX512DQ__) && defined(__AVX512VL__)
+    for (; i + 4 <= n; i += 4) {
+        const __m256d d = _mm256_cvtepi64_pd(i64v::load(x + i));
+        _mm256_storeu_pd(out + i, _mm256_div_pd(d, vm));
+    }
+#else
+    // Integers in [-2^51, 2^51) convert exactly by placing x + 2^51 in the
+    // mantissa of 2^52 and subtracting 1.5 * 2^52.
+    const __m256i bias = _mm256_set1_epi64x(1LL << 51);
+    const __m256i exponent = _mm256_set1_epi64x(0x4330000000000000LL);
+    const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+    for (; i + 4 <= n; i += 4) {
+        const __m256i t = _mm256_add_epi64(i64v::load(x + i), bias);
+        const __m256i high = _mm256_srli_epi64(t, 52);
+        if (not _mm256_testz_si256(high, high))
+            break;
+        const __m256d d = _mm256_sub_pd(
+                _mm256_castsi256_pd(_mm256_or_si256(t, exponent)), magic);
+        _mm256_storeu_pd(out + i, _mm256_div_pd(d, vm));
+    }
+#endif
+#endif
+    for (; i != n; ++i)
+        out[i] = static_cast<double>(x[i]) / m;
+}
+
+#endif // ASH_DECIMAL_SIMD
+
+template<typename I>
+void to_double(const I* x, double* out, std::size_t n, double m)
+{
+    for (std::size_t i = 0; i != n; ++i)
+        out[i] = static_cast<double>(x[i]) / m;
+}
+
+template<unsigned char E, class Rounding, typename I>
+std::size_t from_double(const double* x, I* out, std::size_t n, std::false_type)
+{
+    for (std::size_t i = 0; i != n; ++i) {
+        if (ash::details::double_to_raw<E, Rounding>(x[i], out[i]) != std::errc{})
+            return i;
+    }
+    return n;
+}
+
+#if defined(__AVX2__) && defined(__FMA__)
+template<typename I>
+using simd_from_double = std::integral_constant<bool,
+      std::is_same<I, long long>::value>;
+
+// While |x| * 10^E < 2^52, its exact value is p + err, where p is the
+// rounded product and err the FMA residual, at most half an ulp of p.
+// Comparing the fraction of p to 0 and 1/2 then only needs err's sign.
+// Other lanes, including NaN and infinity, go through double_to_raw().
+template<unsigned char E, class Rounding>
+std::size_t from_double(
+        const double* x, long long* out, std::size_t n, std::true_type)
+{
+    const __m256d m = _mm256_set1_pd(static_cast<double>(c_pow<long long, 10, E>::value));
+    const __m256d two52 = _mm256_set1_pd(4503599627370496.0);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256i mantissa = _mm256_set1_epi64x((1LL << 52) - 1);
+    const __m256i table = _mm256_set1_epi64x(ash::details::round_up_table<Rounding>());
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d v = _mm256_loadu_pd(x + i);
+        const __m256d a = _mm256_andnot_pd(sign, v);
+        const __m256d p = _mm256_mul_pd(a, m);
+        if (_mm256_movemask_pd(_mm256_cmp_pd(p, two52, _CMP_LT_OQ)) != 0xF) {
+            const std::size_t k = from_double<E, Rounding>(
+                    x + i, out + i, 4, std::false_type{});
+            if (k != 4)
+                return i + k;
+            continue;
+        }
+        const __m256d err = _mm256_fmsub_pd(a, m, p);
+        __m256d q = _mm256_floor_pd(p);
+        const __m256d d = _mm256_sub_pd(p, q);
+
+        const __m256d d0 = _mm256_cmp_pd(d, zero, _CMP_EQ_OQ);
+        const __m256d err0 = _mm256_cmp_pd(err, zero, _CMP_EQ_OQ);
+        // An integral p with a negative residual is just below p.
+        const __m256d borrow = _mm256_and_pd(d0, _mm256_cmp_pd(err, zero, _CMP_LT_OQ));
+        q = _mm256_sub_pd(q, _mm256_and_pd(borrow, one));
+        const __m256d d_half = _mm256_cmp_pd(d, half, _CMP_EQ_OQ);
+        const __m256d above = _mm256_or_pd(
+                _mm256_or_pd(borrow, _mm256_cmp_pd(d, half, _CMP_GT_OQ)),
+                _mm256_and_pd(d_half, _mm256_cmp_pd(err, zero, _CMP_GT_OQ)));
+        const __m256d tie = _mm256_and_pd(d_half, err0);
+        const __m256d exact = _mm256_and_pd(d0, err0);
+
+        // 0 <= q < 2^52 is the mantissa of q + 2^52.
+        const __m256i qi = _mm256_and_si256(
+                _mm256_castpd_si256(_mm256_add_pd(q, two52)), mantissa);
+        const __m256i bits = _mm256_castpd_si256(v);
+        __m256i idx = _mm256_and_si256(qi, _mm256_set1_epi64x(1));
+        idx = _mm256_or_si256(idx, _mm256_and_si256(
+                    _mm256_castpd_si256(tie), _mm256_set1_epi64x(2)));
+        idx = _mm256_or_si256(idx, _mm256_and_si256(
+                    _mm256_castpd_si256(above), _mm256_set1_epi64x(4)));
+        idx = _mm256_or_si256(idx, _mm256_andnot_si256(
+                    _mm256_castpd_si256(exact), _mm256_set1_epi64x(8)));
+        idx = _mm256_or_si256(idx, _mm256_slli_epi64(_mm256_srli_epi64(bits, 63), 4));
+        const __m256i up = _mm256_and_si256(
+                _mm256_srlv_epi64(table, idx), _mm256_set1_epi64x(1));
+
+        const __m256i r = _mm256_add_epi64(qi, up);
+        const __m256i neg = _mm256_cmpgt_epi64(_mm256_setzero_si256(), bits);
+        _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(out + i),
+                _mm256_sub_epi64(_mm256_xor_si256(r, neg), neg));
+    }
+    return i + from_double<E, Rounding>(x + i, out + i, n - i, std::false_type{});
+}
+#else
+template<typename I>
+using simd_from_double = std::false_type;
+#endif
+
+} // namespace details
+
+// Sum of xs, accumulated in the underlying integer type.
+template<class D>
+details::decimal_t<D> sum(span<D> xs)
+{
+    using I = details::raw_t<D>;
+    return details::decimal_t<D>::from_raw_value(details::sum(
+            details::raw(xs), xs.size(), details::simd_arith<I>{}));
+}
+
+// out[i] = xs[i] * k. out may alias xs.
+template<class D, class O>
+void scale(span<D> xs, details::raw_t<D> k, span<O> out)
+{
+    static_assert(std::is_same<details::decimal_t<D>, O>::value, "Type mismatch.");
+    assert(out.size() >= xs.size());
+    using I = details::raw_t<D>;
+    details::scale(
+            details::raw(xs), k, details::raw_out(out), xs.size(),
+            details::simd_arith<I>{});
+}
+
+// out[i] = ash::multiply<Policy, Rounding>(xs[i], ys[i]), so products are
+// formed in 128 bits and the defaults match operator*. out may alias xs.
+template<
+    class Policy = overflow::wrap,
+    class Rounding = rounding::truncate,
+    class D, class O>
+void mul(span<D> xs, span<D> ys, span<O> out)
+{
+    static_assert(std::is_same<details::decimal_t<D>, O>::value, "Type mismatch.");
+    assert(ys.size() >= xs.size() and out.size() >= xs.size());
+    for (std::size_t i = 0; i != xs.size(); ++i)
+        out[i] = ash::multiply<Policy, Rounding>(xs[i], ys[i]);
+}
+
+// Converts xs to exponent F, truncating digits that do not fit.
+template<unsigned char F, class D, class O>
+void rescale(span<D> xs, span<O> out)
+{
+    using I = details::raw_t<D>;
+    static_assert(
+            std::is_same<fixed_decimal<F, I>, O>::value,
+            "Output must be a fixed_decimal<F> of the same integer type.");
+    assert(out.size() >= xs.size());
+    constexpr unsigned char E = details::decimal_t<D>::exponent();
+    const I* x = details::raw(xs);
+    I* z = details::raw_out(out);
+    if (F >= E) {
+        constexpr I k = c_pow<I, 10, (F >= E) ? F - E : 0>::value;
+        details::scale(x, k, z, xs.size(), details::simd_arith<I>{});
+    } else {
+        constexpr I k = c_pow<I, 10, (E >= F) ? E - F : 0>::value;
+        for (std::size_t i = 0; i != xs.size(); ++i)
+            z[i] = x[i] / k;
+    }
+}
+
+template<class D>
+void to_double(span<D> xs, span<double> out)
+{
+    assert(out.size() >= xs.size());
+    details::to_double(
+            details::raw(xs), out.data(), xs.size(),
+            static_cast<double>(details::decimal_t<D>::multiplier()));
+}
+
+// Converts xs with from_double(). Stops at the first value that is not
+// finite or does not fit, returning its index, or xs.size() if all convert.
+template<class Rounding = rounding::half_even, class O>
+std::size_t from_double(span<const double> xs, span<O> out)
+{
+    static_assert(details::is_fixed_decimal<O>::value, "Not a fixed_decimal.");
+    assert(out.size() >= xs.size());
+    using I = typename O::value_type;
+    return details::from_double<O::exponent(), Rounding>(
+            xs.data(), details::raw_out(out), xs.size(),
+            details::simd_from_double<I>{});
+}
+
+// Smallest element of xs, which must not be empty.
+template<class D>
+details::decimal_t<D> min(span<D> xs)
+{
+    assert(not xs.empty());
+    using I = details::raw_t<D>;
+    return details::decimal_t<D>::from_raw_value(details::reduce(
+            details::raw(xs), xs.size(),
+            details::min_op{}, details::simd_signed<I>{}));
+}
+
+// Largest element of xs, which must not be empty.
+template<class D>
+details::decimal_t<D> max(span<D> xs)
+{
+    assert(not xs.empty());
+    using I = details::raw_t<D>;
+    return details::decimal_t<D>::from_raw_value(details::reduce(
+            details::raw(xs), xs.size(),
+            details::max_op{}, details::simd_signed<I>{}));
+}
+
+} // namespace decimal
+
+} // namespace ash
@@ -0,0 +1,461 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+#include "compare_base.h"
+#include "fixed_decimal.h"
+
+namespace ash {
+
+namespace details {
+
+// Largest E for which 10^E fits IntegerT.
+template<typename IntegerT>
+constexpr
+unsigned max_exponent()
+{
+    using U = unsigned_of_t<IntegerT>;
+    unsigned n = 0;
+    for (U p = 1; p <= U(std::numeric_limits<IntegerT>::max()) / 10; p *= 10)
+        ++n;
+    return n;
+}
+
+// 10^n with the reciprocal used to divide by it, see reciprocal_div().
+// magic is zero where no reciprocal applies: for n = 0 and for powers past
+// half the word, which go through the 0 or 1 quotient instead.
+template<typename U>
+struct pow10_entry
+{
+    U power;
+    U magic;
+    unsigned shift;
+};
+
+template<typename U>
+struct pow10_table
+{
+    pow10_entry<U> entries[max_pow10<U>() + 1];
+};
+
+template<typename U>
+constexpr
+pow10_table<U> make_pow10_table()
+{
+    pow10_table<U> table{};
+    U p = 1;
+    for (unsigned n = 0; n <= max_pow10<U>(); ++n) {
+        table.entries[n].power = p;
+#if defined(__SIZEOF_INT128__)
+        if (n != 0 and p <= U(~U(0)) / 2) {
+            table.entries[n].magic = reciprocal(p);
+            table.entries[n].shift = ceil_log2(p) - 1;
+        }
+#endif
+        if (n != max_pow10<U>())
+            p *= 10;
+    }
+    return table;
+}
+
+template<typename U>
+const pow10_table<U>& pow10_entries() noexcept
+{
+    static constexpr pow10_table<U> table = make_pow10_table<U>();
+    return table;
+}
+
+// 10^n for n <= max_pow10<U>().
+template<typename U>
+U pow10_n(unsigned n) noexcept
+{
+    assert(n <= max_pow10<U>());
+    return pow10_entries<U>().entries[n].power;
+}
+
+#if defined(__SIZEOF_INT128__)
+template<typename U>
+U quot_pow10_n(const pow10_entry<U>& e, U v) noexcept
+{
+    if (e.magic == 0)
+        return (e.power == 1) ? v : U(v >= e.power);
+    const U t = mul_high(e.magic, v);
+    return (t + ((v - t) >> 1)) >> e.shift;
+}
+
+template<typename U>
+U quot_pow10_n(U v, unsigned n, std::true_type) noexcept
+{
+    return static_cast<U>(quot_pow10_n(
+                pow10_entries<std::uint64_t>().entries[n],
+                static_cast<std::uint64_t>(v)));
+}
+
+inline
+uint128_t quot_pow10_n(uint128_t v, unsigned n) noexcept
+{
+    if ((v >> 64) == 0 and n <= max_pow10<std::uint64_t>())
+        return quot_pow10_n(std::uint64_t(v), n, std::true_type{});
+    return quot_pow10_n(pow10_entries<uint128_t>().entries[n], v);
+}
+#else
+template<typename U>
+U quot_pow10_n(U v, unsigned n, std::true_type) noexcept
+{
+    return v / pow10_n<U>(n);
+}
+#endif
+
+template<typename U>
+U quot_pow10_n(U v, unsigned n, std::false_type) noexcept
+{
+    return v / pow10_n<U>(n);
+}
+
+// v / 10^n for a runtime n <= max_pow10<U>(), by table lookup.
+template<typename U>
+U quot_pow10_n(U v, unsigned n) noexcept
+{
+    return quot_pow10_n(v, n, std::integral_constant<bool, sizeof(U) == 8>{});
+}
+
+// v / 10^n rounded by Rounding, any n.
+template<class Rounding, typename W>
+W scale_down_n(W v, unsigned n)
+{
+    using U = unsigned_of_t<W>;
+    if (n == 0)
+        return v;
+    if (n > max_pow10<U>())
+        return div_pow10_n<Rounding, 0>(v, n, std::false_type{});
+    const U mag = magnitude(v);
+    const U q = quot_pow10_n(mag, n);
+    return round_quotient<Rounding, W>(
+            q, mag - q * pow10_n<U>(n), pow10_n<U>(n), v < W(0));
+}
+
+// v * 10^n in W. Returns true if W overflowed, only checked when the
+// policy asks for it.
+template<class Policy, typename W>
+bool scale_up_n(W v, unsigned n, W& out)
+{
+    using U = unsigned_of_t<W>;
+    if (n > max_pow10<U>()) {
+        out = 0;
+        return Policy::check and v != W(0);
+    }
+    return mul_overflow<Policy>(v, static_cast<W>(pow10_n<U>(n)), out);
+}
+
+// Converts v from `from` to `to` decimal places.
+template<class Policy, class Rounding, typename IntegerT>
+IntegerT rescale_n(IntegerT v, unsigned from, unsigned to)
+{
+    using W = wide_integer_t<IntegerT>;
+    if (to < from)
+        return static_cast<IntegerT>(scale_down_n<Rounding>(W(v), from - to));
+    W w;
+    if (scale_up_n<Policy>(W(v), to - from, w))
+        return Policy::template overflowed<IntegerT>(v < IntegerT(0));
+    return narrow<Policy, IntegerT>(w);
+}
+
+} // namespace details
+
+// A decimal whose exponent is chosen at runtime: raw_value() units of
+// 10^-exponent(). A single instantiation serves every precision, so code
+// handling instruments with different tick sizes does not multiply out per
+// exponent. Rescaling divides through a table of reciprocals of powers of
+// ten. Mixed exponents combine like fixed_decimal: sums, products and
+// quotients take the larger exponent.
+template<typename IntegerT = long long>
+class dynamic_decimal : compareable<dynamic_decimal<IntegerT>>
+{
+public:
+    using value_type = IntegerT;
+    using wide_type = details::wide_integer_t<IntegerT>;
+
+public:
+    dynamic_decimal() = default;
+
+    // Exact, the exponent is taken from the type.
+    template<unsigned char E>
+    constexpr
+    dynamic_decimal(const fixed_decimal<E, IntegerT>& src) :
+        value_{src.raw_value()},
+        exponent_{E}
+    { }
+
+public:
+    // Largest supported exponent, 18 for 64-bit integers.
+    static constexpr
+    unsigned char max_exponent()
+    {
+        return static_cast<unsigned char>(details::max_exponent<IntegerT>());
+    }
+
+    static
+    dynamic_decimal from_raw_value(value_type v, unsigned char exponent)
+    {
+        assert(exponent <= max_exponent());
+        dynamic_decimal r;
+        r.value_ = v;
+        r.exponent_ = exponent;
+        return r;
+    }
+
+    value_type raw_value() const noexcept
+    {
+        return value_;
+    }
+
+    unsigned char exponent() const noexcept
+    {
+        return exponent_;
+    }
+
+    value_type multiplier() const noexcept
+    {
+        return static_cast<value_type>(
+                details::pow10_n<details::unsigned_of_t<IntegerT>>(exponent_));
+    }
+
+    // The same value with the given number of decimals, rounding by
+    // Rounding when digits are dropped.
+    template<
+        class Policy = overflow::wrap,
+        class Rounding = rounding::truncate>
+    dynamic_decimal rescale(unsigned char exponent) const
+    {
+        return from_raw_value(
+                details::rescale_n<Policy, Rounding>(value_, exponent_, exponent),
+                exponent);
+    }
+
+    template<
+        unsigned char E,
+        class Policy = overflow::wrap,
+        class Rounding = rounding::truncate>
+    fixed_decimal<E, IntegerT> to_fixed() const
+    {
+        return fixed_decimal<E, IntegerT>::from_raw_value(
+                details::rescale_n<Policy, Rounding>(value_, exponent_, E));
+    }
+
+    explicit operator double() const
+    {
+        return as_double();
+    }
+
+    double as_double() const
+    {
+        return static_cast<double>(value_) / static_cast<double>(multiplier());
+    }
+
+    dynamic_decimal operator-() const
+    {
+        return from_raw_value(
+                static_cast<value_type>(value_type(0) - value_), exponent_);
+    }
+
+    // Comparisons are exact, the operands are aligned in wide_type.
+    bool operator==(const dynamic_decimal& rhs) const
+    {
+        if (exponent_ == rhs.exponent_)
+            return value_ == rhs.value_;
+        return aligned(rhs.exponent_) == rhs.aligned(exponent_);
+    }
+
+    bool operator<(const dynamic_decimal& rhs) const
+    {
+        if (exponent_ == rhs.exponent_)
+            return value_ < rhs.value_;
+        return aligned(rhs.exponent_) < rhs.aligned(exponent_);
+    }
+
+private:
+    // The raw value in units of 10^-max(exponent(), other).
+    wide_type aligned(unsigned char other) const
+    {
+        wide_type w = value_;
+        if (other > exponent_)
+            details::scale_up_n<overflow::wrap>(w, other - exponent_, w);
+        return w;
+    }
+
+private:
+    IntegerT value_{0};
+    unsigned char exponent_{0};
+};
+
+namespace details {
+
+// a + b, or a - b when negate_b. Both operands are aligned and combined in
+// the wide type, so no IntegerT value is ever negated.
+template<class Policy, typename IntegerT>
+dynamic_decimal<IntegerT> add_aligned(
+        const dynamic_decimal<IntegerT>& a,
+        const dynamic_decimal<IntegerT>& b,
+        bool negate_b)
+{
+    using W = wide_integer_t<IntegerT>;
+    const auto e = std::max(a.exponent(), b.exponent());
+    using result = dynamic_decimal<IntegerT>;
+    W wa, wb;
+    if (scale_up_n<Policy>(W(a.raw_value()), e - a.exponent(), wa)) {
+        return result::from_raw_value(
+                Policy::template overflowed<IntegerT>(a.raw_value() < 0), e);
+    }
+    if (scale_up_n<Policy>(W(b.raw_value()), e - b.exponent(), wb)) {
+        return result::from_raw_value(
+                Policy::template overflowed<IntegerT>(
+                    (b.raw_value() < 0) != negate_b), e);
+    }
+    return result::from_raw_value(
+            narrow<Policy, IntegerT>(negate_b ? wa - wb : wa + wb), e);
+}
+
+} // namespace details
+
+template<
+    class Policy = overflow::wrap,
+    typename IntegerT>
+dynamic_decimal<IntegerT> add(
+        const dynamic_decimal<IntegerT>& a,
+        const dynamic_decimal<IntegerT>& b)
+{
+    return details::add_aligned<Policy>(a, b, false);
+}
+
+template<
+    class Policy = overflow::wrap,
+    typename IntegerT>
+dynamic_decimal<IntegerT> subtract(
+        const dynamic_decimal<IntegerT>& a,
+        const dynamic_decimal<IntegerT>& b)
+{
+    return details::add_aligned<Policy>(a, b, true);
+}
+
+// See multiply() for fixed_decimal. The product is rounded to
+// max(a.exponent(), b.exponent()) decimals.
+template<
+    class Policy = overflow::wrap,
+    class Rounding = rounding::truncate,
+    typename IntegerT>
+dynamic_decimal<IntegerT> multiply(
+        const dynamic_decimal<IntegerT>& a,
+        const dynamic_decimal<IntegerT>& b)
+{
+    using W = details::wide_integer_t<IntegerT>;
+    const auto e = std::max(a.exponent(), b.exponent());
+    W product;
+    if (details::mul_overflow<Policy>(W(a.raw_value()), W(b.raw_value()), product)) {
+        return dynamic_decimal<IntegerT>::from_raw_value(
+                Policy::template overflowed<IntegerT>(
+                    (a.raw_value() < 0) != (b.raw_value() < 0)), e);
+    }
+    product = details::scale_down_n<Rounding>(
+            product, std::min(a.exponent(), b.exponent()));
+    return dynamic_decimal<IntegerT>::from_raw_value(
+            details::narrow<Policy, IntegerT>(product), e);
+}
+
+// See divide() for fixed_decimal. The quotient is rounded to
+// max(lhs.exponent(), rhs.exponent()) decimals.
+template<
+    class Policy = overflow::wrap,
+    class Rounding = rounding::truncate,
+    typename IntegerT>
+dynamic_decimal<IntegerT> divide(
+        const dynamic_decimal<IntegerT>& lhs,
+        const dynamic_decimal<IntegerT>& rhs)
+{
+    using W = details::wide_integer_t<IntegerT>;
+    const auto e = std::max(lhs.exponent(), rhs.exponent());
+    const bool negative = (lhs.raw_value() < 0) != (rhs.raw_value() < 0);
+    W numer;
+    if (details::scale_up_n<Policy>(
+                W(lhs.raw_value()), e - lhs.exponent() + rhs.exponent(), numer))
+    {
+        return dynamic_decimal<IntegerT>::from_raw_value(
+                Policy::template overflowed<IntegerT>(negative), e);
+    }
+    return dynamic_decimal<IntegerT>::from_raw_value(
+            details::narrow<Policy, IntegerT>(
+                details::div_round<Rounding>(numer, W(rhs.raw_value()))), e);
+}
+
+template<typename IntegerT>
+dynamic_decimal<IntegerT> operator+(
+        const dynamic_decimal<IntegerT>& a,
+        const dynamic_decimal<IntegerT>& b)
+{
+    return add(a, b);
+}
+
+template<typename IntegerT>
+dynamic_decimal<IntegerT> operator-(
+        const dynamic_decimal<IntegerT>& a,
+        const dynamic_decimal<IntegerT>& b)
+{
+    return subtract(a, b);
+}
+
+template<typename IntegerT>
+dynamic_decimal<IntegerT> operator*(
+        const dynamic_decimal<IntegerT>& a,
+        const dynamic_decimal<IntegerT>& b)
+{
+    return multiply(a, b);
+}
+
+template<typename IntegerT>
+dynamic_decimal<IntegerT> operator/(
+        const dynamic_decimal<IntegerT>& lhs,
+        const dynamic_decimal<IntegerT>& rhs)
+{
+    return divide(lhs, rhs);
+}
+
+template<typename IntegerT>
+std::ostream& operator<<(std::ostream& out, const dynamic_decimal<IntegerT>& src)
+{
+    using unsigned_type = details::unsigned_of_t<IntegerT>;
+    const auto raw = src.raw_value();
+    if (raw < IntegerT(0))
+        out << '-';
+    unsigned_type val = details::magnitude(raw);
+    unsigned_type divisor = static_cast<unsigned_type>(src.multiplier());
+    for (unsigned dig = 0; dig != src.exponent() + 1u; ++dig) {
+        out << (val / divisor);
+        if (dig == 0)
+            out << '.';
+        val %= divisor;
+        divisor /= 10;
+    }
+    return out;
+}
+
+} // namespace ash
@@ -17,9 +17,16 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <ostream>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+#include <type_traits>
 
 #include "c_utils.h"
 #include "compare_base.h"
@@ -37,6 +44,500 @@ static_assert(scaling_factor<int, 10, 2, 5>::value == 1000, "Wrong scaling facto
 static_assert(scaling_factor<int, 10, 5, 5>::value == 1, "Wrong scaling factor.");
 static_assert(scaling_factor<int, 10, 4, 3>::value == 1, "Wrong scaling factor.");
 
+template<typename T>
+struct unsigned_of : std::make_unsigned<T>
+{ };
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+
+template<>
+struct unsigned_of<int128_t>
+{
+    using type = uint128_t;
+};
+
+template<>
+struct unsigned_of<uint128_t>
+{
+    using type = uint128_t;
+};
+
+// Intermediate type wide enough to hold the product of two IntegerT.
+template<typename IntegerT>
+using wide_integer_t = std::conditional_t<
+    (sizeof(IntegerT) > sizeof(long long)), IntegerT,
+    std::conditional_t<std::is_signed<IntegerT>::value, int128_t, uint128_t>>;
+#else
+template<typename IntegerT>
+using wide_integer_t = IntegerT;
+#endif
+
+template<typename T>
+using unsigned_of_t = typename unsigned_of<T>::type;
+
+template<typename T>
+constexpr
+T pow10(unsigned n)
+{
+    T r = 1;
+    while (n-- != 0)
+        r *= 10;
+    return r;
+}
+
+// Largest n for which 10^n fits in U.
+template<typename U>
+constexpr
+unsigned max_pow10()
+{
+    unsigned n = 0;
+    for (U p = 1; p <= U(~U(0)) / 10; p *= 10)
+        ++n;
+    return n;
+}
+
+template<typename IntegerT, typename W>
+constexpr
+bool fits(W v)
+{
+    return v >= W(std::numeric_limits<IntegerT>::min()) and
+           v <= W(std::numeric_limits<IntegerT>::max());
+}
+
+template<typename W>
+constexpr
+unsigned_of_t<W> magnitude(W v)
+{
+    using U = unsigned_of_t<W>;
+    return (v < W(0)) ? U(0) - U(v) : U(v);
+}
+
+// v / 10^N for types narrower than 64 bits, where the compiler already
+// replaces division by a constant with a multiply-high and shift.
+template<unsigned N, typename U>
+constexpr
+U quot_pow10(U v, std::false_type)
+{
+    return v / pow10<U>(N);
+}
+
+#if defined(__SIZEOF_INT128__)
+constexpr
+std::uint64_t mul_high(std::uint64_t a, std::uint64_t b)
+{
+    return static_cast<std::uint64_t>((uint128_t(a) * b) >> 64);
+}
+
+constexpr
+uint128_t mul_high(uint128_t a, uint128_t b)
+{
+    const std::uint64_t a0 = a, a1 = a >> 64, b0 = b, b1 = b >> 64;
+    const uint128_t p00 = uint128_t(a0) * b0, p01 = uint128_t(a0) * b1;
+    const uint128_t p10 = uint128_t(a1) * b0, p11 = uint128_t(a1) * b1;
+    const uint128_t mid = (p00 >> 64) + std::uint64_t(p01) + std::uint64_t(p10);
+    return p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+}
+
+template<typename U>
+constexpr
+unsigned ceil_log2(U d)
+{
+    unsigned l = 0;
+    while (l != sizeof(U) * 8 and (U(1) << l) < d)
+        ++l;
+    return l;
+}
+
+// Granlund and Montgomery's reciprocal of d for a word of U:
+// floor(2^bits * (2^l - d) / d) + 1 with l = ceil(log2(d)).
+template<typename U>
+constexpr
+U reciprocal(U d)
+{
+    U r = (U(1) << ceil_log2(d)) - d;
+    U m = 0;
+    for (unsigned i = 0; i != sizeof(U) * 8; ++i) {
+        r <<= 1;
+        m <<= 1;
+        if (r >= d) {
+            r -= d;
+            m |= 1;
+        }
+    }
+    return m + 1;
+}
+
+template<unsigned N, typename U>
+constexpr
+U reciprocal_div(U v)
+{
+    constexpr U d = pow10<U>(N);
+    // Past half the word the quotient is 0 or 1 and l would not fit.
+    constexpr bool large = d > U(~U(0)) / 2;
+    constexpr U m = large ? U(0) : reciprocal(d);
+    constexpr unsigned shift = (N == 0 or large) ? 0 : ceil_log2(d) - 1;
+    if (N == 0)
+        return v;
+    if (large)
+        return v >= d;
+    const U t = mul_high(m, v);
+    return (t + ((v - t) >> 1)) >> shift;
+}
+
+// GCC emits a div for some 64-bit powers of ten, and calls the runtime's
+// division routine for any 128-bit one, so multiply by the reciprocal.
+template<unsigned N, typename U>
+constexpr
+U quot_pow10(U v, std::true_type)
+{
+    return static_cast<U>(reciprocal_div<N>(static_cast<std::uint64_t>(v)));
+}
+
+template<unsigned N>
+constexpr
+uint128_t quot_pow10(uint128_t v)
+{
+    if ((v >> 64) == 0 and N <= 19)
+        return quot_pow10<N>(std::uint64_t(v), std::true_type{});
+    return reciprocal_div<N>(v);
+}
+#else
+template<unsigned N, typename U>
+constexpr
+U quot_pow10(U v, std::true_type)
+{
+    return v / pow10<U>(N);
+}
+#endif
+
+// v / 10^N without a division instruction.
+template<unsigned N, typename U>
+constexpr
+U quot_pow10(U v)
+{
+    return quot_pow10<N>(v, std::integral_constant<bool, sizeof(U) == 8>{});
+}
+
+} // namespace details
+
+// Rounding modes for rescaling. round_up() is given the parity of the
+// truncated quotient, how the discarded remainder compares to half a unit,
+// whether anything was discarded and the sign of the result. It returns
+// whether the magnitude of the quotient is incremented.
+namespace rounding {
+
+// Toward zero, as the operators do.
+struct truncate
+{
+    static constexpr
+    bool round_up(bool, int, bool, bool)
+    {
+        return false;
+    }
+};
+
+// Ties away from zero.
+struct half_up
+{
+    static constexpr
+    bool round_up(bool, int half, bool, bool)
+    {
+        return half >= 0;
+    }
+};
+
+// Ties to even.
+struct half_even
+{
+    static constexpr
+    bool round_up(bool odd, int half, bool, bool)
+    {
+        return half > 0 or (half == 0 and odd);
+    }
+};
+
+// Toward negative infinity.
+struct floor
+{
+    static constexpr
+    bool round_up(bool, int, bool inexact, bool negative)
+    {
+        return inexact and negative;
+    }
+};
+
+// Toward positive infinity.
+struct ceil
+{
+    static constexpr
+    bool round_up(bool, int, bool inexact, bool negative)
+    {
+        return inexact and not negative;
+    }
+};
+
+} // namespace rounding
+
+// Overflow policies for multiply() and divide().
+namespace overflow {
+
+// Results are truncated to IntegerT without checking, as the operators do.
+struct wrap
+{
+    static const constexpr bool check = false;
+
+    template<typename IntegerT>
+    static constexpr
+    IntegerT overflowed(bool)
+    {
+        return IntegerT{0};
+    }
+};
+
+// Throws std::overflow_error.
+struct checked
+{
+    static const constexpr bool check = true;
+
+    template<typename IntegerT>
+    [[noreturn]] static
+    IntegerT overflowed(bool)
+    {
+        throw std::overflow_error("fixed_decimal overflow");
+    }
+};
+
+// Clamps to the nearest representable value.
+struct saturate
+{
+    static const constexpr bool check = true;
+
+    template<typename IntegerT>
+    static constexpr
+    IntegerT overflowed(bool negative)
+    {
+        return negative ?
+            std::numeric_limits<IntegerT>::min() :
+            std::numeric_limits<IntegerT>::max();
+    }
+};
+
+} // namespace overflow
+
+namespace details {
+
+template<class Rounding, typename W, typename U>
+constexpr
+W round_quotient(U q, U rem, U divisor, bool negative)
+{
+    const U rest = divisor - rem;
+    const int half = (rem < rest) ? -1 : (rem == rest ? 0 : 1);
+    if (Rounding::round_up((q & 1) != 0, half, rem != 0, negative))
+        ++q;
+    return negative ? W(U(0) - q) : W(q);
+}
+
+// v / 10^N rounded by Rounding.
+template<unsigned N, class Rounding, typename W>
+constexpr
+W div_pow10(W v)
+{
+    using U = unsigned_of_t<W>;
+    constexpr U divisor = pow10<U>(N);
+    const U mag = magnitude(v);
+    const U q = quot_pow10<N>(mag);
+    return round_quotient<Rounding, W>(q, mag - q * divisor, divisor, v < W(0));
+}
+
+template<class Rounding, unsigned N, typename W>
+constexpr
+W div_pow10_n(W v, unsigned, std::false_type)
+{
+    // 10^n exceeds W, only the sign and whether v is zero remain.
+    return Rounding::round_up(false, -1, v != W(0), v < W(0)) ?
+        (v < W(0) ? W(0) - W(1) : W(1)) : W(0);
+}
+
+template<class Rounding, unsigned N, typename W>
+constexpr
+W div_pow10_n(W v, unsigned n, std::true_type)
+{
+    using next = std::integral_constant<bool,
+          (N < max_pow10<unsigned_of_t<W>>())>;
+    return (n == N) ?
+        div_pow10<N, Rounding>(v) :
+        div_pow10_n<Rounding, N + 1>(v, n, next{});
+}
+
+// v / 10^n for a runtime n, dispatched to a constant divisor.
+template<class Rounding, typename W>
+constexpr
+W scale_down(W v, unsigned n)
+{
+    return div_pow10_n<Rounding, 0>(v, n, std::true_type{});
+}
+
+template<unsigned char From, unsigned char To, class Rounding, typename T>
+constexpr
+T rescale(T v, std::true_type)
+{
+    return div_pow10<From - To, Rounding>(v);
+}
+
+template<unsigned char From, unsigned char To, class Rounding, typename T>
+constexpr
+T rescale(T v, std::false_type)
+{
+    return v * pow10<T>(To - From);
+}
+
+// Converts a raw value with From decimals to one with To decimals.
+template<unsigned char From, unsigned char To, class Rounding, typename T>
+constexpr
+T rescale(T v)
+{
+    return rescale<From, To, Rounding>(
+            v, std::integral_constant<bool, (To < From)>{});
+}
+
+// num / den rounded by Rounding, natively when both fit 64 bits.
+template<class Rounding, typename W>
+constexpr
+W div_round(W num, W den)
+{
+    using U = unsigned_of_t<W>;
+    constexpr U native = U(std::numeric_limits<std::uint64_t>::max());
+    const U n = magnitude(num);
+    const U d = magnitude(den);
+    const U q = (n <= native and d <= native) ?
+        U(std::uint64_t(n) / std::uint64_t(d)) : n / d;
+    return round_quotient<Rounding, W>(
+            q, n - q * d, d, (num < W(0)) != (den < W(0)));
+}
+
+template<class Policy, typename IntegerT, typename W>
+constexpr
+IntegerT narrow(W v)
+{
+    if (Policy::check and not fits<IntegerT>(v))
+        return Policy::template overflowed<IntegerT>(v < W(0));
+    return static_cast<IntegerT>(v);
+}
+
+// Multiplies in W, returns true if W itself overflowed. Only checked when
+// the policy asks for it.
+template<class Policy, typename W>
+constexpr
+bool mul_overflow(W a, W b, W& out)
+{
+    if (Policy::check)
+        return __builtin_mul_overflow(a, b, &out);
+    out = a * b;
+    return false;
+}
+
+// Rounding::round_up() for each combination of its arguments, indexed by
+// odd | (half + 1) << 1 | inexact << 3 | negative << 4.
+template<class Rounding>
+constexpr
+std::uint32_t round_up_table()
+{
+    std::uint32_t table = 0;
+    for (unsigned i = 0; i != 32; ++i) {
+        const int half = static_cast<int>((i >> 1) & 3) - 1;
+        if (half <= 1 and Rounding::round_up(
+                    (i & 1) != 0, half, ((i >> 3) & 1) != 0, ((i >> 4) & 1) != 0))
+        {
+            table |= std::uint32_t(1) << i;
+        }
+    }
+    return table;
+}
+
+#if defined(__SIZEOF_INT128__)
+// Rounds the exact value of x * 10^E into out. x is split into m * 2^k, so
+// that m * 5^E * 2^(k + E) is formed without error in 128 bits.
+template<unsigned char E, class Rounding, typename IntegerT>
+std::errc double_to_raw(double x, IntegerT& out)
+{
+    static_assert(E <= 27, "5^E must fit 64 bits.");
+    using U = unsigned_of_t<IntegerT>;
+    constexpr std::uint64_t pow5 = ash::c_pow<std::uint64_t, 5, E>::value;
+    constexpr std::uint32_t round_up = round_up_table<Rounding>();
+
+    std::uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const bool negative = (bits >> 63) != 0;
+    const unsigned biased = static_cast<unsigned>(bits >> 52) & 0x7FF;
+    if (biased == 0x7FF)
+        return std::errc::invalid_argument;
+    std::uint64_t m = bits & ((std::uint64_t(1) << 52) - 1);
+    if (biased != 0)
+        m |= std::uint64_t(1) << 52;
+    const int s = std::max(1, int(biased)) - 1075 + int(E);
+
+    const uint128_t product = uint128_t(m) * pow5;
+    // Largest magnitude for the sign, without branching on it.
+    const U max = static_cast<U>(std::numeric_limits<IntegerT>::max());
+    const uint128_t limit = std::is_signed<IntegerT>::value ?
+        uint128_t(max) + negative : uint128_t(max) * not negative;
+    uint128_t q = product;
+    if (s >= 0) {
+        if (product != 0 and (s >= 64 or product > (limit >> s)))
+            return std::errc::result_out_of_range;
+        q = (product == 0) ? 0 : product << s;
+    } else {
+        const unsigned shift = static_cast<unsigned>(-s);
+        // Past 127 bits the product is below half a unit.
+        int half = -1;
+        uint128_t rem = product;
+        if (shift < 128) {
+            q = product >> shift;
+            rem = product - (q << shift);
+            const uint128_t h = uint128_t(1) << (shift - 1);
+            half = int(rem > h) - int(rem < h);
+        } else {
+            q = 0;
+        }
+        // A lookup rather than a branch, the outcome is data dependent.
+        const unsigned idx = unsigned(q & 1) | unsigned(half + 1) << 1 |
+            unsigned(rem != 0) << 3 | unsigned(negative) << 4;
+        q += (round_up >> idx) & 1;
+        if (q > limit)
+            return std::errc::result_out_of_range;
+    }
+    const U sign = U(0) - U(negative);
+    out = static_cast<IntegerT>((U(q) ^ sign) - sign);
+    return std::errc{};
+}
+#else
+template<unsigned char E, class Rounding, typename IntegerT>
+std::errc double_to_raw(double x, IntegerT& out)
+{
+    if (not std::isfinite(x))
+        return std::errc::invalid_argument;
+    // Without 128-bit integers the product is only as exact as long double.
+    const long double p = std::fabs(static_cast<long double>(x)) *
+        static_cast<long double>(c_pow<IntegerT, 10, E>::value);
+    const long double q = std::floor(p);
+    const long double rem = p - q;
+    const int half = (rem < 0.5L) ? -1 : (rem == 0.5L ? 0 : 1);
+    const bool negative = std::signbit(x);
+    const long double r = q + (Rounding::round_up(
+                std::fmod(q, 2.0L) != 0, half, rem != 0, negative) ? 1 : 0);
+    const long double v = negative ? -r : r;
+    if (v < static_cast<long double>(std::numeric_limits<IntegerT>::min()) or
+        v > static_cast<long double>(std::numeric_limits<IntegerT>::max()))
+    {
+        return std::errc::result_out_of_range;
+    }
+    out = static_cast<IntegerT>(v);
+    return std::errc{};
+}
+#endif
+
 } // namespace details
 
 template<unsigned char E, typename IntegerT = long long>
@@ -68,13 +569,11 @@ public:
         value_{static_cast<IntegerT>(value * Multiplier)}
     { }
 
-    template <
-        unsigned char F, typename FInt,
-        IntegerT FM = other_mul<F>::value,
-        IntegerT EM = self_mul<F>::value>
+    template <unsigned char F, typename FInt>
     constexpr
     explicit fixed_decimal(const fixed_decimal<F, FInt>& src) :
-        value_{(FM * src.raw_value()) / EM}
+        value_{details::rescale<F, E, rounding::truncate>(
+                static_cast<IntegerT>(src.raw_value()))}
     { }
 
 public:
@@ -91,17 +590,29 @@ public:
     }
 
     static constexpr
-    self_type from_raw_value(value_type v, unsigned char vex = Exponent)
+    self_type from_raw_value(value_type v)
     {
-        if (vex < Exponent)
-            return from_raw_value(v * 10, vex + 1);
-        else if (vex > Exponent)
-            return from_raw_value(v / 10, vex - 1);
         self_type r;
         r.value_ = v;
         return r;
     }
 
+    // Interprets v as having vex decimal places, rounding by Rounding if
+    // that is more than Exponent.
+    template<class Rounding = rounding::truncate>
+    static constexpr
+    self_type from_raw_value(value_type v, unsigned char vex)
+    {
+        self_type r;
+        if (vex == Exponent)
+            r.value_ = v;
+        else if (vex < Exponent)
+            r.value_ = v * details::pow10<IntegerT>(Exponent - vex);
+        else
+            r.value_ = details::scale_down<Rounding>(v, vex - Exponent);
+        return r;
+    }
+
     template<typename T>
     static constexpr
     self_type from_fraction(T numer, T denom)
@@ -240,6 +751,78 @@ private:
     IntegerT value_{0};
 };
 
+// Products and quotients are formed in a 128-bit intermediate where
+// available, so only results that do not fit IntegerT overflow. Policy
+// decides what happens then, see ash::overflow. Rounding applies to the
+// digits past max(E, F), see ash::rounding.
+template<
+    class Policy = overflow::wrap,
+    class Rounding = rounding::truncate,
+    unsigned char E, unsigned char F, typename IntegerT>
+constexpr
+fixed_decimal<std::max(E, F), IntegerT> multiply(
+        const fixed_decimal<E, IntegerT>& a,
+        const fixed_decimal<F, IntegerT>& b)
+{
+    using wide = details::wide_integer_t<IntegerT>;
+    using ret_type = fixed_decimal<std::max(E, F), IntegerT>;
+    wide product{0};
+    if (details::mul_overflow<Policy>(
+                wide(a.raw_value()), wide(b.raw_value()), product))
+        return ret_type::from_raw_value(Policy::template overflowed<IntegerT>(
+                    (a.raw_value() < 0) != (b.raw_value() < 0)));
+    // a * 10^-E * b * 10^-F in units of 10^-max(E, F).
+    return ret_type::from_raw_value(details::narrow<Policy, IntegerT>(
+                details::div_pow10<std::min(E, F), Rounding>(product)));
+}
+
+template<class Policy = overflow::wrap, unsigned char E, typename IntegerT, typename T>
+constexpr
+std::enable_if_t<std::is_integral<T>::value, fixed_decimal<E, IntegerT>>
+multiply(const fixed_decimal<E, IntegerT>& a, T n)
+{
+    using wide = details::wide_integer_t<IntegerT>;
+    wide product{0};
+    if (details::mul_overflow<Policy>(wide(a.raw_value()), wide(n), product))
+        return fixed_decimal<E, IntegerT>::from_raw_value(
+                Policy::template overflowed<IntegerT>(
+                    (a.raw_value() < 0) != (n < 0)));
+    return fixed_decimal<E, IntegerT>::from_raw_value(
+            details::narrow<Policy, IntegerT>(product));
+}
+
+template<
+    class Policy = overflow::wrap,
+    class Rounding = rounding::truncate,
+    unsigned char E, unsigned char F, typename IntegerT>
+constexpr
+fixed_decimal<std::max(E, F), IntegerT> divide(
+        const fixed_decimal<E, IntegerT>& lhs,
+        const fixed_decimal<F, IntegerT>& rhs)
+{
+    using wide = details::wide_integer_t<IntegerT>;
+    using ret_type = fixed_decimal<std::max(E, F), IntegerT>;
+    // (l * 10^-E) / (r * 10^-F) in units of 10^-max(E, F).
+    constexpr wide scale = details::pow10<wide>(std::max(E, F) - E + F);
+    wide numer{0};
+    if (details::mul_overflow<Policy>(wide(lhs.raw_value()), scale, numer))
+        return ret_type::from_raw_value(Policy::template overflowed<IntegerT>(
+                    (lhs.raw_value() < 0) != (rhs.raw_value() < 0)));
+    return ret_type::from_raw_value(details::narrow<Policy, IntegerT>(
+                details::div_round<Rounding>(numer, wide(rhs.raw_value()))));
+}
+
+// Rounds x to F decimal places.
+template<
+    unsigned char F, class Rounding = rounding::truncate,
+    unsigned char E, typename IntegerT>
+constexpr
+fixed_decimal<F, IntegerT> round_to(const fixed_decimal<E, IntegerT>& x)
+{
+    return fixed_decimal<F, IntegerT>::from_raw_value(
+            details::rescale<E, F, Rounding>(x.raw_value()));
+}
+
 template<unsigned char E, typename IntegerT, typename T>
 constexpr
 fixed_decimal<E, IntegerT> operator/(
@@ -251,19 +834,30 @@ fixed_decimal<E, IntegerT> operator/(
             rhs.raw_value());
 }
 
-template<
-    unsigned char E,
-    unsigned char F,
-    typename IntegerT,
-    class ret_type = fixed_decimal<std::max(E, F), IntegerT>,
-    IntegerT EM = details::scaling_factor<IntegerT, 10, E, F>::value,
-    IntegerT FM = details::scaling_factor<IntegerT, 10, F, E>::value>
-constexpr
-ret_type operator/(
+template<unsigned char E, unsigned char F, typename IntegerT>
+constexpr
+fixed_decimal<std::max(E, F), IntegerT> operator/(
         const fixed_decimal<E, IntegerT>& lhs,
         const fixed_decimal<F, IntegerT>& rhs)
 {
-    return ret_type{lhs.raw_value() * EM} / (rhs.raw_value() * FM);
+    return divide(lhs, rhs);
+}
+
+// Converts value to E decimal places, rounding its exact binary value by
+// Rounding; 0.29 is slightly below 29 hundredths, so only the nearest modes
+// give 0.29. Returns std::errc::invalid_argument for NaN or infinity and
+// std::errc::result_out_of_range if the result does not fit IntegerT. x is
+// left unchanged on error.
+template<
+    class Rounding = rounding::half_even,
+    unsigned char E, typename IntegerT>
+std::errc from_double(double value, fixed_decimal<E, IntegerT>& x)
+{
+    IntegerT raw;
+    const std::errc ec = details::double_to_raw<E, Rounding>(value, raw);
+    if (ec == std::errc{})
+        x = fixed_decimal<E, IntegerT>::from_raw_value(raw);
+    return ec;
 }
 
 template<unsigned char E, typename IntegerT, typename T>
@@ -275,21 +869,13 @@ fixed_decimal<E, IntegerT> operator/(
     return fixed_decimal<E, IntegerT>::from_raw_value(lhs.raw_value() / rhs);
 }
 
-template<
-    unsigned char E,
-    unsigned char F,
-    typename IntegerT,
-    class ret_type = fixed_decimal<std::max(E, F), IntegerT>,
-    IntegerT EM = details::scaling_factor<IntegerT, 10, E, F>::value,
-    IntegerT FM = details::scaling_factor<IntegerT, 10, F, E>::value>
-constexpr
-ret_type operator*(
+template<unsigned char E, unsigned char F, typename IntegerT>
+constexpr
+fixed_decimal<std::max(E, F), IntegerT> operator*(
         const fixed_decimal<E, IntegerT>& a,
         const fixed_decimal<F, IntegerT>& b)
 {
-    constexpr IntegerT RM{ret_type::multiplier()};
-    return ret_type::from_raw_value(
-            (a.raw_value() * EM * b.raw_value() * FM) / RM);
+    return multiply(a, b);
 }
 
 
@@ -312,13 +898,20 @@ fixed_decimal<E, IntegerT> operator*(
 template<unsigned char E, typename IntegerT>
 std::ostream& operator<<(std::ostream& out, const fixed_decimal<E, IntegerT>& src)
 {
-    auto val = src.raw_value();
-    auto divisor = src.multiplier();
+    using unsigned_type = std::make_unsigned_t<IntegerT>;
+    const auto raw = src.raw_value();
+    // Print the sign separately, the integer part of -0.5 is zero.
+    if (raw < IntegerT(0))
+        out << '-';
+    unsigned_type val = (raw < IntegerT(0)) ?
+        unsigned_type(0) - static_cast<unsigned_type>(raw) :
+        static_cast<unsigned_type>(raw);
+    unsigned_type divisor = src.multiplier();
     for (unsigned dig = 0; dig != src.exponent() + 1; ++dig) {
         out << (val / divisor);
         if (dig == 0)
             out << '.';
-        val = std::abs(val % divisor);
+        val %= divisor;
         divisor /= 10;
     }
     return out;
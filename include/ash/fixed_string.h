@@ -22,8 +22,13 @@
 #include <cstdint>
 #include <cstring>
 #include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
 
+#include "charconv.h"
 #include "compare_base.h"
+#include "string_kernels.h"
 
 namespace ash {
 
@@ -155,31 +160,37 @@ public:
 
     size_type find(const CharT* s, size_type pos = 0) const
     {
-        size_type d_idx = pos;
-        size_type s_idx = 0;
-        while (d_idx + s_idx != Capacity and s[s_idx] != '\0') {
-            if (data_[d_idx + s_idx] == s[s_idx]) {
-                // Matched a character.
-                ++s_idx;
-            } else {
-                // Restart search.
-                ++d_idx;
-                s_idx = 0;
-            }
-        }
-        return (s[s_idx] == '\0') ? d_idx : npos;
+        return details::str_find<Capacity>(
+                data_, scan_length(), s, traits::length(s), pos, simd{});
     }
 
     size_type find(CharT ch, size_type pos = 0) const
     {
-        for (size_type i = pos; i != Capacity; ++i) {
-            if (data_[i] == ch) {
-                return i;
-            } else if (data_[i] == '\0') {
-                return npos;
-            }
-        }
-        return npos;
+        return details::str_find<Capacity>(
+                data_, scan_length(), ch, pos, simd{});
+    }
+
+    size_type rfind(const CharT* s, size_type pos = npos) const
+    {
+        return details::str_rfind<Capacity>(
+                data_, scan_length(), s, traits::length(s), pos, simd{});
+    }
+
+    size_type rfind(CharT ch, size_type pos = npos) const
+    {
+        return details::str_rfind<Capacity>(
+                data_, scan_length(), ch, pos, simd{});
+    }
+
+    size_type find_first_of(const CharT* s, size_type pos = 0) const
+    {
+        return details::str_find_first_of<Capacity>(
+                data_, scan_length(), s, traits::length(s), pos, simd{});
+    }
+
+    size_type find_first_of(CharT ch, size_type pos = 0) const
+    {
+        return find(ch, pos);
     }
 
     fixed_string& insert(size_type index, size_type count, CharT ch)
@@ -224,15 +235,62 @@ public:
         return insert(length(), s);
     }
 
+    // Formats a number with ash::to_chars straight into the buffer. Digits
+    // are never cut off: if the number does not fit the string is unchanged
+    // and std::length_error is thrown, try_append() returns the error
+    // instead.
+    template<typename IntegerT, details::enable_if_number_t<IntegerT> = 0>
+    fixed_string& append(IntegerT value)
+    {
+        return checked(try_append(value));
+    }
+
+    template<unsigned char E, typename IntegerT>
+    fixed_string& append(
+            const fixed_decimal<E, IntegerT>& value,
+            trailing_zeros zeros = trailing_zeros::keep)
+    {
+        return checked(try_append(value, zeros));
+    }
+
+    fixed_string& append(
+            double value, unsigned places = 6,
+            trailing_zeros zeros = trailing_zeros::keep)
+    {
+        return checked(try_append(value, places, zeros));
+    }
+
+    template<typename IntegerT, details::enable_if_number_t<IntegerT> = 0>
+    std::errc try_append(IntegerT value) noexcept
+    {
+        return format_back([value](char* first, char* last) {
+            return ash::to_chars(first, last, value);
+        });
+    }
+
+    template<unsigned char E, typename IntegerT>
+    std::errc try_append(
+            const fixed_decimal<E, IntegerT>& value,
+            trailing_zeros zeros = trailing_zeros::keep) noexcept
+    {
+        return format_back([&value, zeros](char* first, char* last) {
+            return ash::to_chars(first, last, value, zeros);
+        });
+    }
+
+    std::errc try_append(
+            double value, unsigned places = 6,
+            trailing_zeros zeros = trailing_zeros::keep) noexcept
+    {
+        return format_back([=](char* first, char* last) {
+            return ash::to_chars(first, last, value, places, zeros);
+        });
+    }
+
     template<std::size_t M>
-    constexpr
     bool operator==(const fixed_string<M, CharT>& rhs) const
     {
-        const size_type len = length();
-        if (len != rhs.length()) return false;
-        for (std::size_t i = 0; i != len; ++i)
-            if (data_[i] != rhs[i]) return false;
-        return true;
+        return details::str_compare<Capacity, M>(data_, rhs.data(), simd{}) == 0;
     }
 
     constexpr
@@ -248,14 +306,11 @@ public:
     }
 
     template<typename Allocator>
-    constexpr
     bool operator==(const std::basic_string<CharT, Allocator>& rhs) const
     {
-        const size_type llen = length();
-        if (llen != rhs.length()) return false;
-        for (size_type i = 0; i != llen; ++i)
-            if (data_[i] != rhs[i]) return false;
-        return true;
+        const size_type len = scan_length();
+        return len == rhs.size() and
+            traits::compare(data_, rhs.data(), len) == 0;
     }
 
     template<size_type M, typename std::enable_if_t<(M < Capacity), int> = 0>
@@ -294,14 +349,43 @@ public:
     }
 
     template<std::size_t M>
-    constexpr
     bool operator<(const fixed_string<M, CharT>& rhs) const
     {
-        return std::lexicographical_compare(
-                begin(), end(), rhs.begin(), rhs.end());
+        return details::str_compare<Capacity, M>(data_, rhs.data(), simd{}) < 0;
     }
 
 private:
+    using traits = std::char_traits<CharT>;
+    using simd = details::str_simd<CharT>;
+
+    // length() stays a plain loop so that it can run in constant
+    // expressions.
+    size_type scan_length() const
+    {
+        return details::str_length<Capacity>(data_, simd{});
+    }
+
+    template<typename Format>
+    std::errc format_back(Format format) noexcept
+    {
+        static_assert(std::is_same<CharT, char>::value,
+                "Numbers are only formatted as char.");
+        const size_type n = scan_length();
+        const to_chars_result res = format(data_ + n, data_ + Capacity);
+        if (res.ec == std::errc{} and res.ptr != data_ + Capacity)
+            *res.ptr = CharT();
+        return res.ec;
+    }
+
+    fixed_string& checked(std::errc ec)
+    {
+        if (ec == std::errc::value_too_large)
+            throw std::length_error("fixed_string: number does not fit");
+        if (ec != std::errc{})
+            throw std::invalid_argument("fixed_string: number not formattable");
+        return *this;
+    }
+
     CharT data_[Capacity] = { 0 };
 };
 
@@ -314,6 +398,21 @@ std::ostream& operator<<(std::ostream& s, const fixed_string<C, T>& src)
     return s << src.c_str();
 }
 
+// Formats value into out, replacing its contents.
+template<std::size_t Capacity, unsigned char E, typename IntegerT>
+std::errc to_chars(
+        fixed_string<Capacity, char>& out,
+        const fixed_decimal<E, IntegerT>& value,
+        trailing_zeros zeros = trailing_zeros::keep) noexcept
+{
+    char buffer[Capacity];
+    const auto res = to_chars(buffer, buffer + Capacity, value, zeros);
+    if (res.ec != std::errc{})
+        return res.ec;
+    out = fixed_string<Capacity, char>(buffer, res.ptr - buffer);
+    return std::errc{};
+}
+
 } // namespace ash
 
 namespace std {
@@ -321,14 +420,12 @@ namespace std {
 template<std::size_t C, typename CharT>
 struct hash<ash::fixed_string<C, CharT>>
 {
-    constexpr
     std::size_t operator()(const ash::fixed_string<C, CharT>& src) const
     {
-        std::size_t h = 0;
-        for (char c : src) {
-            (h <<= 1) ^= static_cast<unsigned char>(c);
-        }
-        return h;
+        using simd = ash::details::str_simd<CharT>;
+        const std::size_t n = ash::details::str_length<C>(src.data(), simd{});
+        return static_cast<std::size_t>(
+                ash::details::str_hash<C>(src.data(), n));
     }
 };
 
@@ -0,0 +1,735 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ASH_FLAT_MAP_SIMD 1
+#else
+#define ASH_FLAT_MAP_SIMD 0
+#endif
+
+#include "fixed_string.h"
+#include "sized_string.h"
+
+namespace ash {
+
+namespace details {
+
+// One control byte per slot: the low 7 bits of the hash of a full slot, or
+// one of the markers below. Markers have the high bit set.
+using flat_ctrl = signed char;
+
+static const constexpr flat_ctrl flat_empty = -128;
+static const constexpr flat_ctrl flat_deleted = -2;
+static const constexpr std::size_t flat_group = 16;
+
+// Bit i is set for each of the 16 control bytes at p that satisfies the test.
+struct flat_group_masks
+{
+#if ASH_FLAT_MAP_SIMD
+    explicit flat_group_masks(const flat_ctrl* p) noexcept :
+        ctrl_{_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}
+    { }
+
+    unsigned match(flat_ctrl h2) const noexcept
+    {
+        return static_cast<unsigned>(_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2))));
+    }
+
+    unsigned empty() const noexcept
+    {
+        return match(flat_empty);
+    }
+
+    unsigned empty_or_deleted() const noexcept
+    {
+        return static_cast<unsigned>(_mm_movemask_epi8(ctrl_));
+    }
+
+private:
+    __m128i ctrl_;
+#else
+    explicit flat_group_masks(const flat_ctrl* p) noexcept :
+        ctrl_{p}
+    { }
+
+    unsigned match(flat_ctrl h2) const noexcept
+    {
+        unsigned m = 0;
+        for (std::size_t i = 0; i != flat_group; ++i)
+            m |= unsigned(ctrl_[i] == h2) << i;
+        return m;
+    }
+
+    unsigned empty() const noexcept
+    {
+        return match(flat_empty);
+    }
+
+    unsigned empty_or_deleted() const noexcept
+    {
+        unsigned m = 0;
+        for (std::size_t i = 0; i != flat_group; ++i)
+            m |= unsigned(ctrl_[i] < 0) << i;
+        return m;
+    }
+
+private:
+    const flat_ctrl* ctrl_;
+#endif
+};
+
+inline std::uint64_t flat_fold(std::uint64_t a, std::uint64_t b) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 wide;
+    const wide r = static_cast<wide>(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+    const std::uint64_t r = a * b;
+    return r ^ (r >> 32);
+#endif
+}
+
+// How flat_map hashes and matches keys. A probe is prepared once per lookup.
+// By default the hash is remixed, since weak hashes such as the identity
+// hash of integers would otherwise crowd into a few groups.
+template<typename Key, typename Hash, typename KeyEqual, typename = void>
+struct flat_key
+{
+    struct probe
+    {
+        std::size_t hash;
+        const Key* key;
+    };
+
+    static probe prepare(const Hash& hash, const Key& key)
+    {
+        const std::uint64_t h = hash(key);
+        return { static_cast<std::size_t>(flat_fold(h, 0x9e3779b97f4a7c15ull)), &key };
+    }
+
+    static bool equal(const KeyEqual& eq, const probe& p, const Key& stored)
+    {
+        return eq(stored, *p.key);
+    }
+};
+
+#if ASH_FLAT_MAP_SIMD
+
+template<typename Key>
+struct flat_short_string : std::false_type { };
+
+template<std::size_t C, typename CharT>
+struct flat_short_string<fixed_string<C, CharT>> :
+    std::integral_constant<bool, sizeof(CharT) == 1 and C <= 16>
+{
+    static const constexpr bool zero_tail = false;
+};
+
+template<std::size_t C, typename CharT>
+struct flat_short_string<sized_string<C, CharT>> :
+    std::integral_constant<bool, sizeof(CharT) == 1 and C <= 16>
+{
+    static const constexpr bool zero_tail = true;
+};
+
+// Strings of up to 16 characters with the default hash and equality are
+// handled as one 16-byte vector with zeros after the last character. The
+// hash is a single multiply of its two halves and equality a single vector
+// compare.
+template<typename Key>
+struct flat_key<
+    Key, std::hash<Key>, std::equal_to<Key>,
+    std::enable_if_t<flat_short_string<Key>::value>>
+{
+    struct probe
+    {
+        std::size_t hash;
+        __m128i bytes;
+    };
+
+    static __m128i load(const Key& key) noexcept
+    {
+        alignas(16) char buf[16] = { 0 };
+        std::memcpy(buf, key.data(), Key::capacity());
+        const __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(buf));
+        if (flat_short_string<Key>::zero_tail)
+            return v;
+        // A fixed_string may keep stale characters past its terminator.
+        const unsigned nul = static_cast<unsigned>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())));
+        const __m128i index = _mm_setr_epi8(
+                0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m128i len = _mm_set1_epi8(static_cast<char>(__builtin_ctz(nul | 0x10000)));
+        return _mm_and_si128(v, _mm_cmplt_epi8(index, len));
+    }
+
+    static probe prepare(const std::hash<Key>&, const Key& key) noexcept
+    {
+        const __m128i v = load(key);
+        alignas(16) std::uint64_t w[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(w), v);
+        const std::uint64_t h = flat_fold(
+                w[0] ^ 0xa0761d6478bd642full, w[1] ^ 0xe7037ed1a0b428dbull);
+        return { static_cast<std::size_t>(h), v };
+    }
+
+    static bool equal(const std::equal_to<Key>&, const probe& p, const Key& stored) noexcept
+    {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(p.bytes, load(stored))) == 0xffff;
+    }
+};
+
+#endif // ASH_FLAT_MAP_SIMD
+
+} // namespace details
+
+// An open addressing hash map in the style of Swiss tables. Entries are
+// stored inline in one array. A parallel array of control bytes holds seven
+// bits of each entry's hash, and lookups test sixteen of them at a time, so
+// keys are compared only on a likely match.
+//
+// Inserting may rehash and so move every entry, unless rehashing has been
+// turned off with allow_rehash(false). Then entries stay put and an insert
+// that needs more room throws std::length_error; reserve() first.
+template<
+    typename Key,
+    typename T,
+    typename Hash = std::hash<Key>,
+    typename KeyEqual = std::equal_to<Key>>
+class flat_map
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+private:
+    using ctrl_t = details::flat_ctrl;
+    using key_ops = details::flat_key<Key, Hash, KeyEqual>;
+    using probe = typename key_ops::probe;
+    using allocator = std::allocator<value_type>;
+    using alloc_traits = std::allocator_traits<allocator>;
+
+    static const constexpr size_type group = details::flat_group;
+    static const constexpr size_type npos = static_cast<size_type>(-1);
+
+    template<bool Const>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename flat_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+    public:
+        basic_iterator() = default;
+
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& src) noexcept :
+            ctrl_{src.ctrl_},
+            slot_{src.slot_},
+            end_{src.end_}
+        { }
+
+        reference operator*() const     { return *slot_; }
+        pointer operator->() const      { return slot_; }
+
+        basic_iterator& operator++() noexcept
+        {
+            ++ctrl_;
+            ++slot_;
+            skip_free();
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept
+        {
+            basic_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs)
+        {
+            return lhs.slot_ == rhs.slot_;
+        }
+
+        friend bool operator!=(const basic_iterator& lhs, const basic_iterator& rhs)
+        {
+            return lhs.slot_ != rhs.slot_;
+        }
+
+    private:
+        friend class flat_map;
+        friend class basic_iterator<true>;
+
+        basic_iterator(const ctrl_t* ctrl, pointer slot, const ctrl_t* end) noexcept :
+            ctrl_{ctrl},
+            slot_{slot},
+            end_{end}
+        { }
+
+        void skip_free() noexcept
+        {
+            while (ctrl_ != end_ and *ctrl_ < 0) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+        const ctrl_t* ctrl_ = nullptr;
+        pointer slot_ = nullptr;
+        const ctrl_t* end_ = nullptr;
+    };
+
+public:
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+public:
+    flat_map() = default;
+
+    explicit flat_map(size_type n)
+    {
+        reserve(n);
+    }
+
+    flat_map(const flat_map& src) :
+        hash_{src.hash_},
+        equal_{src.equal_},
+        rehash_{src.rehash_}
+    {
+        // Without rehashing the copy needs all the room src reserved.
+        if (rehash_)
+            reserve(src.size());
+        else if (src.capacity_ != 0)
+            resize(src.capacity_);
+        for (const auto& kv : src)
+            emplace_new(prepare(kv.first).hash, kv);
+    }
+
+    flat_map(flat_map&& src) noexcept :
+        hash_{std::move(src.hash_)},
+        equal_{std::move(src.equal_)},
+        rehash_{src.rehash_}
+    {
+        steal(src);
+    }
+
+    ~flat_map()
+    {
+        destroy();
+    }
+
+    flat_map& operator=(flat_map src) noexcept
+    {
+        swap(src);
+        return *this;
+    }
+
+    void swap(flat_map& src) noexcept
+    {
+        using std::swap;
+        swap(hash_, src.hash_);
+        swap(equal_, src.equal_);
+        swap(ctrl_, src.ctrl_);
+        swap(slots_, src.slots_);
+        swap(capacity_, src.capacity_);
+        swap(size_, src.size_);
+        swap(growth_left_, src.growth_left_);
+        swap(rehash_, src.rehash_);
+    }
+
+    //
+    // Iterators
+    //
+
+    iterator begin() noexcept
+    {
+        iterator it{ctrl_, slots_, ctrl_ + capacity_};
+        it.skip_free();
+        return it;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        const_iterator it{ctrl_, slots_, ctrl_ + capacity_};
+        it.skip_free();
+        return it;
+    }
+
+    iterator end() noexcept
+    {
+        return iterator{ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator{ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_};
+    }
+
+    const_iterator cbegin() const noexcept  { return begin(); }
+    const_iterator cend() const noexcept    { return end(); }
+
+    //
+    // Capacity
+    //
+
+    bool empty() const noexcept         { return size_ == 0; }
+    size_type size() const noexcept     { return size_; }
+    size_type capacity() const noexcept { return capacity_; }
+
+    // Makes room for n entries in total without rehashing. Throws
+    // std::length_error if that needs more room while rehashing is off.
+    void reserve(size_type n)
+    {
+        if (n <= size_ + growth_left_)
+            return;
+        if (not rehash_ and capacity_ != 0)
+            throw std::length_error("flat_map: reserve with rehash disabled");
+        size_type cap = group;
+        while (max_load(cap) < n)
+            cap *= 2;
+        resize(cap);
+    }
+
+    // While false, entries never move: inserts and reserve() calls that
+    // need more room than reserved throw std::length_error.
+    void allow_rehash(bool allow) noexcept
+    {
+        rehash_ = allow;
+    }
+
+    bool rehash_allowed() const noexcept
+    {
+        return rehash_;
+    }
+
+    //
+    // Lookup
+    //
+
+    iterator find(const Key& key)
+    {
+        const size_type i = find_index(prepare(key));
+        return i == npos ? end() : make_iterator(i);
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        const size_type i = find_index(prepare(key));
+        return i == npos ? end() : const_iterator{ctrl_ + i, slots_ + i, ctrl_ + capacity_};
+    }
+
+    size_type count(const Key& key) const
+    {
+        return find_index(prepare(key)) != npos;
+    }
+
+    bool contains(const Key& key) const
+    {
+        return count(key) != 0;
+    }
+
+    T& at(const Key& key)
+    {
+        const size_type i = find_index(prepare(key));
+        if (i == npos)
+            throw std::out_of_range("flat_map::at");
+        return slots_[i].second;
+    }
+
+    const T& at(const Key& key) const
+    {
+        return const_cast<flat_map&>(*this).at(key);
+    }
+
+    T& operator[](const Key& key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    //
+    // Modifiers
+    //
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+    {
+        const probe p = prepare(key);
+        const size_type i = find_index(p);
+        if (i != npos)
+            return { make_iterator(i), false };
+        const size_type j = emplace_new(
+                p.hash, std::piecewise_construct, std::forward_as_tuple(key),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+        return { make_iterator(j), true };
+    }
+
+    std::pair<iterator, bool> insert(const value_type& kv)
+    {
+        return try_emplace(kv.first, kv.second);
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(const Key& key, Args&&... args)
+    {
+        return try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    size_type erase(const Key& key)
+    {
+        const size_type i = find_index(prepare(key));
+        if (i == npos)
+            return 0;
+        erase_index(i);
+        return 1;
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        const size_type i = static_cast<size_type>(pos.ctrl_ - ctrl_);
+        erase_index(i);
+        iterator it = make_iterator(i);
+        it.skip_free();
+        return it;
+    }
+
+    void clear() noexcept
+    {
+        for (size_type i = 0; i != capacity_; ++i) {
+            if (ctrl_[i] >= 0)
+                alloc_traits::destroy(alloc_, slots_ + i);
+        }
+        if (capacity_ != 0)
+            std::memset(ctrl_, details::flat_empty, capacity_ + group);
+        size_ = 0;
+        growth_left_ = max_load(capacity_);
+    }
+
+private:
+    // Seven eighths of the slots may be in use, full or deleted.
+    static constexpr size_type max_load(size_type cap) noexcept
+    {
+        return cap - cap / 8;
+    }
+
+    probe prepare(const Key& key) const
+    {
+        return key_ops::prepare(hash_, key);
+    }
+
+    static ctrl_t h2(std::size_t h) noexcept
+    {
+        return static_cast<ctrl_t>(h & 0x7f);
+    }
+
+    iterator make_iterator(size_type i) noexcept
+    {
+        return iterator{ctrl_ + i, slots_ + i, ctrl_ + capacity_};
+    }
+
+    // Groups are visited at triangular offsets, which cover every group
+    // when the capacity is a power of two.
+    size_type find_index(const probe& p) const
+    {
+        if (size_ == 0)
+            return npos;
+        const std::size_t h = p.hash;
+        const size_type mask = capacity_ - 1;
+        size_type pos = (h >> 7) & mask;
+        for (size_type step = group;; step += group) {
+            const details::flat_group_masks g{ctrl_ + pos};
+            for (unsigned m = g.match(h2(h)); m != 0; m &= m - 1) {
+                const size_type i = (pos + static_cast<size_type>(__builtin_ctz(m))) & mask;
+                if (key_ops::equal(equal_, p, slots_[i].first))
+                    return i;
+            }
+            if (g.empty())
+                return npos;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    size_type find_free(std::size_t h) const noexcept
+    {
+        const size_type mask = capacity_ - 1;
+        size_type pos = (h >> 7) & mask;
+        for (size_type step = group;; step += group) {
+            const unsigned m = details::flat_group_masks{ctrl_ + pos}.empty_or_deleted();
+            if (m != 0)
+                return (pos + static_cast<size_type>(__builtin_ctz(m))) & mask;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    // The first group_width control bytes are mirrored past the end, so a
+    // group can be loaded at any position without wrapping.
+    void set_ctrl(size_type i, ctrl_t c) noexcept
+    {
+        ctrl_[i] = c;
+        if (i < group)
+            ctrl_[capacity_ + i] = c;
+    }
+
+    template<typename... Args>
+    size_type emplace_new(std::size_t h, Args&&... args)
+    {
+        size_type i = capacity_ == 0 ? npos : find_free(h);
+        if (i == npos or (growth_left_ == 0 and ctrl_[i] == details::flat_empty)) {
+            grow();
+            i = find_free(h);
+        }
+        alloc_traits::construct(alloc_, slots_ + i, std::forward<Args>(args)...);
+        if (ctrl_[i] == details::flat_empty)
+            --growth_left_;
+        set_ctrl(i, h2(h));
+        ++size_;
+        return i;
+    }
+
+    // A slot can go back to empty, rather than deleted, if no probe ever
+    // passed over it: that is, if no run of full or deleted slots around it
+    // spans a whole group.
+    void erase_index(size_type i) noexcept
+    {
+        const size_type mask = capacity_ - 1;
+        alloc_traits::destroy(alloc_, slots_ + i);
+        --size_;
+
+        const unsigned after = details::flat_group_masks{ctrl_ + i}.empty();
+        const unsigned before =
+            details::flat_group_masks{ctrl_ + ((i - group) & mask)}.empty();
+        const bool never_full =
+            after != 0 and before != 0 and
+            static_cast<size_type>(__builtin_ctz(after)) +
+            static_cast<size_type>(__builtin_clz(before) - 16) < group;
+        if (never_full) {
+            set_ctrl(i, details::flat_empty);
+            ++growth_left_;
+        } else {
+            set_ctrl(i, details::flat_deleted);
+        }
+    }
+
+    // Doubles the capacity, or only clears deleted slots if they make up
+    // much of the load.
+    void grow()
+    {
+        if (not rehash_ and capacity_ != 0)
+            throw std::length_error("flat_map: capacity reached with rehash disabled");
+        if (capacity_ == 0)
+            resize(group);
+        else if (size_ <= max_load(capacity_) / 2)
+            resize(capacity_);
+        else
+            resize(capacity_ * 2);
+    }
+
+    void resize(size_type cap)
+    {
+        std::unique_ptr<ctrl_t[]> ctrl{new ctrl_t[cap + group]};
+        std::memset(ctrl.get(), details::flat_empty, cap + group);
+        value_type* slots = alloc_traits::allocate(alloc_, cap);
+
+        flat_map old;
+        old.steal(*this);
+        ctrl_ = ctrl.release();
+        slots_ = slots;
+        capacity_ = cap;
+        size_ = 0;
+        growth_left_ = max_load(cap);
+        for (size_type i = 0; i != old.capacity_; ++i) {
+            if (old.ctrl_[i] < 0)
+                continue;
+            auto& kv = old.slots_[i];
+            const std::size_t h = prepare(kv.first).hash;
+            const size_type j = find_free(h);
+            alloc_traits::construct(
+                    alloc_, slots_ + j, std::piecewise_construct,
+                    std::forward_as_tuple(std::move(const_cast<Key&>(kv.first))),
+                    std::forward_as_tuple(std::move(kv.second)));
+            set_ctrl(j, h2(h));
+            --growth_left_;
+            ++size_;
+        }
+    }
+
+    void steal(flat_map& src) noexcept
+    {
+        ctrl_ = src.ctrl_;
+        slots_ = src.slots_;
+        capacity_ = src.capacity_;
+        size_ = src.size_;
+        growth_left_ = src.growth_left_;
+        src.ctrl_ = nullptr;
+        src.slots_ = nullptr;
+        src.capacity_ = src.size_ = src.growth_left_ = 0;
+    }
+
+    void destroy() noexcept
+    {
+        if (capacity_ == 0)
+            return;
+        clear();
+        delete[] ctrl_;
+        alloc_traits::deallocate(alloc_, slots_, capacity_);
+    }
+
+private:
+    Hash hash_;
+    KeyEqual equal_;
+    allocator alloc_;
+    ctrl_t* ctrl_ = nullptr;
+    value_type* slots_ = nullptr;
+    size_type capacity_ = 0;
+    size_type size_ = 0;
+    size_type growth_left_ = 0;
+    bool rehash_ = true;
+};
+
+template<typename K, typename T, typename H, typename E>
+void swap(flat_map<K, T, H, E>& lhs, flat_map<K, T, H, E>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+} // namespace ash
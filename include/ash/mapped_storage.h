@@ -0,0 +1,443 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "page_alloc.h"
+
+namespace ash {
+
+namespace details {
+
+struct mapped_header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint32_t record_align;
+    std::uint32_t page_size;
+    std::uint64_t first_chunk_bytes;
+    // Records covered by the last checkpoint(), the only count recovered.
+    std::uint64_t committed;
+};
+
+[[noreturn]] inline
+void throw_errno(const char* what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace details
+
+// stable_storage of trivially copyable records living in a file. The file
+// starts with a one page header followed by chunks that double in size, each
+// mapped separately so created records never move. Reopening the file maps
+// the existing chunks; no record is read or parsed. Only records covered by
+// a checkpoint() are recovered, the kernel may write the header page back
+// before the records it counts.
+template<typename T>
+class mapped_storage
+{
+private:
+    static_assert(
+            std::is_trivially_copyable<T>::value,
+            "Records must be trivially copyable.");
+
+    using header_type = details::mapped_header;
+
+    struct chunk_view
+    {
+        T* data;
+        std::size_t capacity;
+    };
+
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using size_type = std::size_t;
+
+    static const constexpr std::uint32_t version = 2;
+    static const constexpr size_type default_chunk_bytes = 64 * 1024;
+
+private:
+    template<typename V>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<V>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+    public:
+        basic_iterator() = default;
+
+        basic_iterator(const mapped_storage* src, size_type chunk) :
+            src_{src},
+            chunk_{chunk}
+        {
+            seek();
+        }
+
+        template<typename W>
+        basic_iterator(const basic_iterator<W>& src) :
+            src_{src.src_},
+            chunk_{src.chunk_},
+            pos_{src.pos_},
+            last_{src.last_}
+        { }
+
+        reference operator*() const     { return *pos_; }
+        pointer operator->() const      { return pos_; }
+
+        basic_iterator& operator++()
+        {
+            if (++pos_ == last_) {
+                ++chunk_;
+                seek();
+            }
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator ret{*this};
+            ++(*this);
+            return ret;
+        }
+
+        template<typename W>
+        bool operator==(const basic_iterator<W>& rhs) const
+        {
+            return pos_ == rhs.pos_;
+        }
+
+        template<typename W>
+        bool operator!=(const basic_iterator<W>& rhs) const
+        {
+            return not (*this == rhs);
+        }
+
+    private:
+        template<typename> friend class basic_iterator;
+
+        void seek()
+        {
+            const auto range = src_->chunk_range(chunk_);
+            pos_ = range.first;
+            last_ = range.second;
+            if (pos_ == last_)
+                pos_ = last_ = nullptr;
+        }
+
+    private:
+        const mapped_storage* src_{nullptr};
+        size_type chunk_{0};
+        pointer pos_{nullptr};
+        pointer last_{nullptr};
+    };
+
+public:
+    using iterator = basic_iterator<T>;
+    using const_iterator = basic_iterator<const T>;
+
+public:
+    // Opens path, creating an empty storage if the file is empty or missing.
+    explicit mapped_storage(
+            const std::string& path,
+            size_type first_chunk_bytes = default_chunk_bytes)
+    {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ == -1)
+            details::throw_errno("ash::mapped_storage: open");
+        try {
+            open_header(first_chunk_bytes);
+            size_ = header_->committed;
+            while (capacity_ < size_)
+                map_chunk();
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    mapped_storage(mapped_storage&& src) :
+        fd_{std::exchange(src.fd_, -1)},
+        header_{std::exchange(src.header_, nullptr)},
+        chunks_{std::move(src.chunks_)},
+        size_{std::exchange(src.size_, 0)},
+        capacity_{std::exchange(src.capacity_, 0)}
+    {
+        src.chunks_.clear();
+    }
+
+    mapped_storage(const mapped_storage&) = delete;
+    mapped_storage& operator=(const mapped_storage&) = delete;
+
+    ~mapped_storage()
+    {
+        unmap();
+    }
+
+    template<typename... Args>
+    reference create(Args&&... args)
+    {
+        const size_type idx = size_;
+        if (idx == capacity_)
+            map_chunk();
+        if (idx < header_->committed)
+            withdraw_checkpoint(idx);
+        auto* obj = new (locate(idx)) T(std::forward<Args>(args)...);
+        size_ = idx + 1;
+        return *obj;
+    }
+
+    // Makes the current records the recovery point. They are flushed to the
+    // file first, then their count is written to the header and flushed.
+    // With async only the header flush is scheduled rather than waited for,
+    // so a crash may recover the previous checkpoint instead.
+    void checkpoint(bool async = false)
+    {
+        for (size_type i = 0; i != chunks_.size(); ++i) {
+            if (::msync(chunks_[i].data, chunk_bytes(i), MS_SYNC) != 0)
+                details::throw_errno("ash::mapped_storage: msync");
+        }
+        header_->committed = size_;
+        sync_header(async ? MS_ASYNC : MS_SYNC);
+    }
+
+    // Checkpointed records stay recoverable until the first create() after
+    // clear(), which shrinks the recovery point before overwriting them.
+    void clear() noexcept
+    {
+        size_ = 0;
+    }
+
+    size_type size() const noexcept         { return size_; }
+    bool empty() const noexcept             { return size() == 0; }
+    size_type capacity() const noexcept     { return capacity_; }
+    size_type chunk_count() const noexcept  { return chunks_.size(); }
+
+    //
+    // Iteration
+    //
+
+    iterator begin()                { return {this, 0}; }
+    iterator end()                  { return {}; }
+    const_iterator begin() const    { return {this, 0}; }
+    const_iterator end() const      { return {}; }
+    const_iterator cbegin() const   { return begin(); }
+    const_iterator cend() const     { return end(); }
+
+    template<typename Func>
+    void for_each(Func&& f)
+    {
+        for_each_chunk([&f](pointer first, pointer last) {
+            std::for_each(first, last, f);
+        });
+    }
+
+    template<typename Func>
+    void for_each(Func&& f) const
+    {
+        for_each_chunk([&f](const_pointer first, const_pointer last) {
+            std::for_each(first, last, f);
+        });
+    }
+
+    // Calls f(first, last) with the contiguous range of each chunk.
+    template<typename Func>
+    void for_each_chunk(Func&& f)
+    {
+        for (size_type i = 0; i != chunks_.size(); ++i) {
+            const auto range = chunk_range(i);
+            if (range.first != range.second)
+                f(range.first, range.second);
+        }
+    }
+
+    template<typename Func>
+    void for_each_chunk(Func&& f) const
+    {
+        for (size_type i = 0; i != chunks_.size(); ++i) {
+            const auto range = chunk_range(i);
+            if (range.first != range.second)
+                f(const_pointer{range.first}, const_pointer{range.second});
+        }
+    }
+
+private:
+    static
+    size_type header_bytes() noexcept
+    {
+        return details::page_size();
+    }
+
+    size_type chunk_bytes(size_type i) const noexcept
+    {
+        return header_->first_chunk_bytes << i;
+    }
+
+    off_t chunk_offset(size_type i) const noexcept
+    {
+        return header_bytes() + header_->first_chunk_bytes * ((1ULL << i) - 1);
+    }
+
+    std::pair<pointer, pointer> chunk_range(size_type i) const noexcept
+    {
+        size_type first = 0;
+        for (size_type c = 0; c != i and c != chunks_.size(); ++c)
+            first += chunks_[c].capacity;
+        if (i >= chunks_.size() or first >= size())
+            return {nullptr, nullptr};
+        const size_type n = std::min(chunks_[i].capacity, size() - first);
+        return {chunks_[i].data, chunks_[i].data + n};
+    }
+
+    pointer locate(size_type idx) const noexcept
+    {
+        // Appends land in the last chunk unless the storage was cleared.
+        const auto& last = chunks_.back();
+        if (idx >= capacity_ - last.capacity)
+            return last.data + (idx - (capacity_ - last.capacity));
+        for (const auto& chunk : chunks_) {
+            if (idx < chunk.capacity)
+                return chunk.data + idx;
+            idx -= chunk.capacity;
+        }
+        return nullptr;
+    }
+
+    void open_header(size_type first_chunk_bytes)
+    {
+        struct stat st;
+        if (::fstat(fd_, &st) != 0)
+            details::throw_errno("ash::mapped_storage: fstat");
+        const bool fresh = (st.st_size == 0);
+        if (fresh and ::ftruncate(fd_, header_bytes()) != 0)
+            details::throw_errno("ash::mapped_storage: ftruncate");
+        if (not fresh and static_cast<size_type>(st.st_size) < header_bytes())
+            throw std::runtime_error("ash::mapped_storage: truncated header");
+
+        void* mem = ::mmap(
+                nullptr, header_bytes(), PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd_, 0);
+        if (mem == MAP_FAILED)
+            details::throw_errno("ash::mapped_storage: mmap");
+        header_ = static_cast<header_type*>(mem);
+
+        if (fresh) {
+            std::memcpy(header_->magic, "ASHSTORE", sizeof(header_->magic));
+            header_->version = version;
+            header_->record_size = sizeof(T);
+            header_->record_align = alignof(T);
+            header_->page_size = static_cast<std::uint32_t>(details::page_size());
+            header_->first_chunk_bytes = details::round_up(
+                    std::max(first_chunk_bytes, sizeof(T)),
+                    details::page_size());
+            header_->committed = 0;
+            sync_header(MS_SYNC);
+        } else if (
+                std::memcmp(header_->magic, "ASHSTORE", 8) != 0 or
+                header_->version != version or
+                header_->record_size != sizeof(T) or
+                header_->record_align != alignof(T) or
+                header_->page_size != details::page_size()) {
+            // Chunk offsets depend on the page size of the writer.
+            throw std::runtime_error("ash::mapped_storage: incompatible file");
+        }
+    }
+
+    void sync_header(int flags)
+    {
+        if (::msync(header_, header_bytes(), flags) != 0)
+            details::throw_errno("ash::mapped_storage: msync");
+    }
+
+    // Records at and after idx are about to be overwritten, so they must
+    // leave the recovery point before any of them change.
+    void withdraw_checkpoint(size_type idx)
+    {
+        header_->committed = idx;
+        sync_header(MS_SYNC);
+    }
+
+    void map_chunk()
+    {
+        const size_type i = chunks_.size();
+        const off_t offset = chunk_offset(i);
+        const size_type bytes = chunk_bytes(i);
+        struct stat st;
+        if (::fstat(fd_, &st) != 0)
+            details::throw_errno("ash::mapped_storage: fstat");
+        if (st.st_size < static_cast<off_t>(offset + bytes) and
+                ::ftruncate(fd_, offset + bytes) != 0)
+            details::throw_errno("ash::mapped_storage: ftruncate");
+
+        void* mem = ::mmap(
+                nullptr, bytes, PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd_, offset);
+        if (mem == MAP_FAILED)
+            details::throw_errno("ash::mapped_storage: mmap");
+        const size_type capacity = bytes / sizeof(T);
+        chunks_.push_back({static_cast<T*>(mem), capacity});
+        capacity_ += capacity;
+    }
+
+    void unmap() noexcept
+    {
+        for (size_type i = 0; i != chunks_.size(); ++i)
+            ::munmap(chunks_[i].data, chunk_bytes(i));
+        chunks_.clear();
+        if (header_ != nullptr)
+            ::munmap(header_, header_bytes());
+        header_ = nullptr;
+        if (fd_ != -1)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+private:
+    int fd_{-1};
+    header_type* header_{nullptr};
+    std::vector<chunk_view> chunks_;
+    size_type size_{0};
+    size_type capacity_{0};
+};
+
+} // namespace ash
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
 #include <new>
 #include <type_traits>
 
@@ -145,4 +146,64 @@ public:
     }
 };
 
+// Stateless allocator handing out single objects from a per-type pool.
+// Larger requests go to operator new.
+template<typename T>
+class pool_allocator
+{
+private:
+    static_assert(
+            alignof(T) <= alignof(std::max_align_t),
+            "Pooled types cannot be over-aligned.");
+
+    using pool_type = details::memory_pool<pool_allocator<T>>;
+    using node_type = memory_pooled<pool_allocator<T>>;
+
+    static constexpr
+    std::size_t block_size()
+    {
+        return sizeof(T) > sizeof(node_type) ? sizeof(T) : sizeof(node_type);
+    }
+
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind { using other = pool_allocator<U>; };
+
+public:
+    pool_allocator() = default;
+
+    template<typename U>
+    pool_allocator(const pool_allocator<U>&) noexcept
+    { }
+
+    T* allocate(std::size_t n)
+    {
+        if (n != 1)
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(pool_type::alloc(block_size()));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        if (n != 1)
+            ::operator delete(ptr);
+        else
+            pool_type::destroy(ptr);
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) noexcept
+{
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) noexcept
+{
+    return false;
+}
+
 } // namespace ash
@@ -18,61 +18,146 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 
+#include "memory_pool.h"
+
 namespace ash {
 
-template<class...> class multipart;
+namespace details {
+
+// A single, separately allocated part. Alloc<T> must be stateless.
+template<template<class> class Alloc, class T>
+class multipart_part {
+private:
+    using allocator_type = Alloc<T>;
+    using alloc_traits = std::allocator_traits<allocator_type>;
 
-template<class... Ts>
-class multipart : multipart<Ts>... {
 public:
-    multipart() = default;
+    multipart_part() = default;
 
-    multipart(std::nullptr_t) :
-        multipart<Ts>{nullptr}...
+    multipart_part(std::nullptr_t)
     { }
 
-    template<class T, typename... Args>
+    multipart_part(multipart_part&& src) noexcept :
+        data_{std::exchange(src.data_, nullptr)}
+    { }
+
+    multipart_part& operator=(multipart_part&& src) noexcept
+    {
+        if (this != &src) {
+            reset();
+            data_ = std::exchange(src.data_, nullptr);
+        }
+        return *this;
+    }
+
+    ~multipart_part()
+    {
+        reset();
+    }
+
+    template<typename... Args>
     void make(Args&&... args)
     {
-        multipart<T>::make(std::forward<Args>(args)...);
+        allocator_type alloc;
+        T* obj = alloc_traits::allocate(alloc, 1);
+        try {
+            alloc_traits::construct(alloc, obj, std::forward<Args>(args)...);
+        } catch (...) {
+            alloc_traits::deallocate(alloc, obj, 1);
+            throw;
+        }
+        reset();
+        data_ = obj;
     }
 
-    template<class T>
-    T& get() { return multipart<T>::get(); }
+    void reset() noexcept
+    {
+        if (data_ == nullptr)
+            return;
+        allocator_type alloc;
+        alloc_traits::destroy(alloc, data_);
+        alloc_traits::deallocate(alloc, data_, 1);
+        data_ = nullptr;
+    }
 
-    template<class T>
-    const T& get() const { return multipart<T>::get(); }
+    // Default constructs the part on first use. A part that is not default
+    // constructible, or any part accessed through const, must be made first
+    // or std::logic_error is thrown.
+    T& get()
+    {
+        if (data_ == nullptr)
+            make_lazily(std::is_default_constructible<T>{});
+        return *data_;
+    }
 
-    template<class T>
-    T* get_ptr() const { return multipart<T>::get_ptr(); }
+    const T& get() const
+    {
+        if (data_ == nullptr)
+            missing();
+        return *data_;
+    }
+
+    T* get_ptr() const      { return data_; }
+
+private:
+    void make_lazily(std::true_type)    { make(); }
+    void make_lazily(std::false_type)   { missing(); }
+
+    [[noreturn]] static
+    void missing()
+    {
+        throw std::logic_error("ash::multipart: part was never made");
+    }
+
+private:
+    T* data_{nullptr};
 };
 
-template<class T>
-class multipart<T> {
+} // namespace details
+
+// Parts are allocated from Alloc<T>. A new multipart holds no parts; each is
+// allocated by its first make<T>() or get<T>().
+template<template<class> class Alloc, class... Ts>
+class basic_multipart : details::multipart_part<Alloc, Ts>... {
 public:
-    multipart() :
-        data_{std::make_unique<T>()}
-    { }
+    basic_multipart() = default;
 
-    multipart(std::nullptr_t) :
-        data_{nullptr}
+    basic_multipart(std::nullptr_t) :
+        details::multipart_part<Alloc, Ts>{nullptr}...
     { }
 
-    template<typename... Args>
+    template<class T, typename... Args>
     void make(Args&&... args)
     {
-        data_ = std::make_unique<T>(std::forward<Args>(args)...);
+        part<T>::make(std::forward<Args>(args)...);
     }
 
+    template<class T>
+    void reset() { part<T>::reset(); }
+
+    template<class T>
+    T& get() { return part<T>::get(); }
 
-    T& get()                { return *data_; }
-    const T& get() const    { return *data_; }
-    T* get_ptr() const      { return data_.get(); }
+    template<class T>
+    const T& get() const { return part<T>::get(); }
+
+    template<class T>
+    T* get_ptr() const { return part<T>::get_ptr(); }
 
 private:
-    std::unique_ptr<T> data_{nullptr};
+    template<class T>
+    using part = details::multipart_part<Alloc, T>;
 };
 
+template<class... Ts>
+using multipart = basic_multipart<std::allocator, Ts...>;
+
+// multipart whose parts come from per-type memory pools.
+template<class... Ts>
+using pooled_multipart = basic_multipart<pool_allocator, Ts...>;
+
 } // namespace ash
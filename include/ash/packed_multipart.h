@@ -0,0 +1,340 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "page_alloc.h"
+
+namespace ash {
+
+// Marks a part of a packed_multipart that is stored out of line.
+template<class T> struct cold;
+
+namespace details {
+
+template<class T>
+struct part_traits
+{
+    using type = T;
+    static const constexpr bool is_cold = false;
+    static const constexpr std::size_t packed_size = sizeof(T);
+    static const constexpr std::size_t packed_align = alignof(T);
+};
+
+template<class T>
+struct part_traits<cold<T>>
+{
+    using type = T;
+    static const constexpr bool is_cold = true;
+    static const constexpr std::size_t packed_size = 0;
+    static const constexpr std::size_t packed_align = 1;
+};
+
+template<class T, class... Ts>
+struct part_index;
+
+template<class T, class U, class... Ts>
+struct part_index<T, U, Ts...> :
+    std::integral_constant<std::size_t,
+        std::is_same<T, typename part_traits<U>::type>::value ?
+            0 : 1 + part_index<T, Ts...>::value>
+{ };
+
+template<class T>
+struct part_index<T> : std::integral_constant<std::size_t, 0> { };
+
+template<class T>
+struct cold_slot { };
+
+template<class T>
+struct cold_slot<cold<T>>
+{
+    std::unique_ptr<T> ptr;
+};
+
+// Offset of the index'th part within the packed block. An index equal to
+// the number of parts gives the size of the block.
+template<class... Ts>
+constexpr
+std::size_t packed_offset(std::size_t index)
+{
+    const std::size_t sizes[] = { part_traits<Ts>::packed_size..., 0 };
+    const std::size_t aligns[] = { part_traits<Ts>::packed_align..., 1 };
+    std::size_t off = 0;
+    for (std::size_t i = 0; i != index; ++i)
+        off = round_up(off, aligns[i]) + sizes[i];
+    return round_up(off, aligns[index]);
+}
+
+template<class... Ts>
+constexpr
+std::size_t packed_align()
+{
+    const std::size_t aligns[] = { part_traits<Ts>::packed_align..., 1 };
+    std::size_t align = 1;
+    for (auto a : aligns)
+        align = std::max(align, a);
+    return align;
+}
+
+} // namespace details
+
+// multipart storing every part in a single allocation, in declaration order.
+// Parts wrapped in ash::cold<T> are allocated separately on make<T>().
+// make<T>() replacing a live part keeps it if the new value throws, unless
+// T's move constructor may throw; parts are destroyed last to first.
+template<class... Ts>
+class packed_multipart
+{
+private:
+    static_assert(sizeof...(Ts) <= 64, "Too many parts.");
+
+    template<class T>
+    using index_of = details::part_index<T, Ts...>;
+
+    template<class T>
+    using is_cold = std::integral_constant<bool,
+          details::part_traits<
+              std::tuple_element_t<index_of<T>::value, std::tuple<Ts...>>
+          >::is_cold>;
+
+    template<std::size_t I>
+    using part_type = typename details::part_traits<
+        std::tuple_element_t<I, std::tuple<Ts...>>>::type;
+
+    static const constexpr std::size_t block_size =
+        details::packed_offset<Ts...>(sizeof...(Ts));
+    static const constexpr std::size_t block_align =
+        details::packed_align<Ts...>();
+
+public:
+    packed_multipart()
+    {
+        if (block_size == 0)
+            return;
+        allocate_block();
+        try {
+            default_construct();
+        } catch (...) {
+            destroy();
+            throw;
+        }
+    }
+
+    packed_multipart(std::nullptr_t)
+    { }
+
+    packed_multipart(packed_multipart&& src) noexcept :
+        block_{std::exchange(src.block_, nullptr)},
+        live_{std::exchange(src.live_, 0)},
+        cold_{std::move(src.cold_)}
+    { }
+
+    packed_multipart& operator=(packed_multipart&& src) noexcept
+    {
+        if (this != &src) {
+            destroy();
+            block_ = std::exchange(src.block_, nullptr);
+            live_ = std::exchange(src.live_, 0);
+            cold_ = std::move(src.cold_);
+        }
+        return *this;
+    }
+
+    packed_multipart(const packed_multipart&) = delete;
+    packed_multipart& operator=(const packed_multipart&) = delete;
+
+    ~packed_multipart()
+    {
+        destroy();
+    }
+
+    template<class T, typename... Args>
+    void make(Args&&... args)
+    {
+        make_impl<T>(is_cold<T>{}, std::forward<Args>(args)...);
+    }
+
+    // Throws std::logic_error if the part was never made.
+    template<class T>
+    T& get() { return *made_ptr<T>(); }
+
+    template<class T>
+    const T& get() const { return *made_ptr<T>(); }
+
+    template<class T>
+    T* get_ptr() const
+    {
+        return get_ptr_impl<T>(is_cold<T>{});
+    }
+
+private:
+    template<class T>
+    static constexpr
+    std::uint64_t live_bit()
+    {
+        return std::uint64_t{1} << index_of<T>::value;
+    }
+
+    template<class T>
+    T* made_ptr() const
+    {
+        T* ptr = get_ptr<T>();
+        if (ptr == nullptr)
+            missing();
+        return ptr;
+    }
+
+    [[noreturn]] static
+    void missing()
+    {
+        throw std::logic_error("ash::packed_multipart: part was never made");
+    }
+
+    template<class T>
+    T* slot() const noexcept
+    {
+        constexpr auto offset = details::packed_offset<Ts...>(index_of<T>::value);
+        return reinterpret_cast<T*>(block_ + offset);
+    }
+
+    template<class T, typename... Args>
+    void make_impl(std::false_type, Args&&... args)
+    {
+        if (block_ == nullptr)
+            allocate_block();
+        if (live_ & live_bit<T>()) {
+            replace_part<T>(
+                    std::is_nothrow_move_constructible<T>{},
+                    std::forward<Args>(args)...);
+            return;
+        }
+        new (slot<T>()) T(std::forward<Args>(args)...);
+        live_ |= live_bit<T>();
+    }
+
+    // The new value is built aside, so a throw leaves the old one in place.
+    template<class T, typename... Args>
+    void replace_part(std::true_type, Args&&... args)
+    {
+        T tmp(std::forward<Args>(args)...);
+        destroy_part<T>(std::false_type{});
+        new (slot<T>()) T(std::move(tmp));
+        live_ |= live_bit<T>();
+    }
+
+    template<class T, typename... Args>
+    void replace_part(std::false_type, Args&&... args)
+    {
+        destroy_part<T>(std::false_type{});
+        new (slot<T>()) T(std::forward<Args>(args)...);
+        live_ |= live_bit<T>();
+    }
+
+    template<class T, typename... Args>
+    void make_impl(std::true_type, Args&&... args)
+    {
+        std::get<index_of<T>::value>(cold_).ptr =
+            std::make_unique<T>(std::forward<Args>(args)...);
+    }
+
+    template<class T>
+    T* get_ptr_impl(std::false_type) const
+    {
+        return (live_ & live_bit<T>()) ? slot<T>() : nullptr;
+    }
+
+    template<class T>
+    T* get_ptr_impl(std::true_type) const
+    {
+        return std::get<index_of<T>::value>(cold_).ptr.get();
+    }
+
+    void default_construct()
+    {
+        using expand = int[];
+        (void) expand{ 0, (default_construct_part<Ts>(
+                    std::integral_constant<bool,
+                        details::part_traits<Ts>::is_cold>{}), 0)... };
+    }
+
+    template<class U>
+    void default_construct_part(std::false_type)
+    {
+        make_impl<U>(std::false_type{});
+    }
+
+    template<class U>
+    void default_construct_part(std::true_type)
+    { }
+
+    template<class T>
+    void destroy_part(std::false_type) noexcept
+    {
+        if (live_ & live_bit<T>()) {
+            slot<T>()->~T();
+            live_ &= ~live_bit<T>();
+        }
+    }
+
+    template<class T>
+    void destroy_part(std::true_type) noexcept
+    {
+        std::get<index_of<T>::value>(cold_).ptr.reset();
+    }
+
+    template<std::size_t... Is>
+    void destroy_parts(std::index_sequence<Is...>) noexcept
+    {
+        using expand = int[];
+        (void) expand{ 0, (destroy_part<part_type<sizeof...(Ts) - 1 - Is>>(
+                    is_cold<part_type<sizeof...(Ts) - 1 - Is>>{}), 0)... };
+    }
+
+    void allocate_block()
+    {
+        block_ = static_cast<unsigned char*>(
+                heap_alloc{}.allocate(block_size, block_align));
+    }
+
+    // Last part first, as members are destroyed.
+    void destroy() noexcept
+    {
+        destroy_parts(std::index_sequence_for<Ts...>{});
+        if (block_ == nullptr)
+            return;
+        heap_alloc{}.deallocate(block_, block_size, block_align);
+        block_ = nullptr;
+    }
+
+private:
+    unsigned char* block_{nullptr};
+    std::uint64_t live_{0};
+    std::tuple<details::cold_slot<Ts>...> cold_;
+};
+
+} // namespace ash
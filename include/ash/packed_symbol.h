@@ -0,0 +1,258 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+
+#include "compare_base.h"
+#include "fixed_string.h"
+#include "string_kernels.h"
+
+namespace ash {
+
+// How packed_symbol encodes characters. Codes run from 1 up in character
+// order, and 0 marks the end, so packed words order like the strings.
+namespace packing {
+
+// Eight bits per character. Holds any string without null characters.
+struct bytes
+{
+    static const constexpr unsigned bits = 8;
+
+    static constexpr unsigned encode(char ch) noexcept
+    {
+        return static_cast<unsigned char>(ch);
+    }
+
+    static constexpr char decode(unsigned code) noexcept
+    {
+        return static_cast<char>(code);
+    }
+};
+
+// Six bits per character, ten to a word. Holds '.', digits and ASCII
+// letters; encode() returns 0 for anything else.
+struct alnum6
+{
+    static const constexpr unsigned bits = 6;
+
+    static constexpr unsigned encode(char ch) noexcept
+    {
+        return ch == '.' ? 1
+            : (ch >= '0' and ch <= '9') ? 2 + unsigned(ch - '0')
+            : (ch >= 'A' and ch <= 'Z') ? 12 + unsigned(ch - 'A')
+            : (ch >= 'a' and ch <= 'z') ? 38 + unsigned(ch - 'a')
+            : 0;
+    }
+
+    static constexpr char decode(unsigned code) noexcept
+    {
+        return code == 1 ? '.'
+            : code < 12 ? static_cast<char>('0' + (code - 2))
+            : code < 38 ? static_cast<char>('A' + (code - 12))
+            : static_cast<char>('a' + (code - 38));
+    }
+};
+
+} // namespace packing
+
+// A string of up to N characters packed into one or two 64-bit words, first
+// character in the most significant bits. Equality, ordering and hashing
+// work on the words alone.
+template<std::size_t N, typename Packing = packing::bytes>
+class packed_symbol : compareable<packed_symbol<N, Packing>>
+{
+public:
+    using size_type = std::size_t;
+
+    static const constexpr unsigned bits = Packing::bits;
+    static const constexpr size_type per_word = 64 / bits;
+    static const constexpr size_type words = (N + per_word - 1) / per_word;
+
+    static_assert(N > 0 and words <= 2, "packed_symbol holds one or two words.");
+
+public:
+    constexpr packed_symbol() noexcept = default;
+
+    // Throws std::length_error if s is longer than N, or
+    // std::invalid_argument if it has a character Packing cannot encode.
+    explicit packed_symbol(const char* s)
+    {
+        check(assign(s, N + 1));
+    }
+
+    template<std::size_t M>
+    explicit packed_symbol(const fixed_string<M, char>& s)
+    {
+        check(assign(s));
+    }
+
+    // Packs up to n characters of s, stopping at a null character. Leaves
+    // the symbol unchanged on error.
+    std::errc assign(const char* s, size_type n) noexcept
+    {
+        std::uint64_t w[2] = { 0, 0 };
+        size_type i = 0;
+        for (; i != n and s[i] != '\0'; ++i) {
+            if (i == N)
+                return std::errc::value_too_large;
+            const unsigned code = Packing::encode(s[i]);
+            if (code == 0)
+                return std::errc::invalid_argument;
+            w[i / per_word] |= std::uint64_t(code) << shift(i);
+        }
+        for (size_type k = 0; k != words; ++k)
+            words_[k] = w[k];
+        return std::errc{};
+    }
+
+    template<std::size_t M>
+    std::errc assign(const fixed_string<M, char>& s) noexcept
+    {
+        return assign_fixed(s, std::integral_constant<bool, bits == 8>{});
+    }
+
+    static constexpr size_type capacity() noexcept  { return N; }
+
+    size_type size() const noexcept
+    {
+        size_type n = 0;
+        for (size_type k = 0; k != words; ++k) {
+            if (words_[k] != 0)
+                n += (64 - static_cast<size_type>(__builtin_ctzll(words_[k])) + bits - 1) / bits;
+        }
+        return n;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+        return words_[0] == 0;
+    }
+
+    // The character at pos < N, or '\0' past the end of the string.
+    char operator[](size_type pos) const noexcept
+    {
+        const unsigned code = static_cast<unsigned>(
+                (words_[pos / per_word] >> shift(pos)) & ((1u << bits) - 1));
+        return code == 0 ? '\0' : Packing::decode(code);
+    }
+
+    fixed_string<N, char> unpack() const noexcept
+    {
+        char buf[N] = { 0 };
+        for (size_type i = 0; i != N and (buf[i] = (*this)[i]) != '\0'; ++i)
+            continue;
+        return fixed_string<N, char>(buf, N);
+    }
+
+    constexpr std::uint64_t word(size_type k) const noexcept
+    {
+        return words_[k];
+    }
+
+    constexpr bool operator==(const packed_symbol& rhs) const noexcept
+    {
+        return words == 1
+            ? words_[0] == rhs.words_[0]
+            : ((words_[0] ^ rhs.words_[0]) | (words_[words - 1] ^ rhs.words_[words - 1])) == 0;
+    }
+
+    constexpr bool operator<(const packed_symbol& rhs) const noexcept
+    {
+        return words == 1
+            ? words_[0] < rhs.words_[0]
+            : words_[0] < rhs.words_[0] or
+              (words_[0] == rhs.words_[0] and words_[words - 1] < rhs.words_[words - 1]);
+    }
+
+private:
+    static constexpr unsigned shift(size_type i) noexcept
+    {
+        return static_cast<unsigned>(64 - bits * (i % per_word + 1));
+    }
+
+    static void check(std::errc err)
+    {
+        if (err == std::errc::value_too_large)
+            throw std::length_error("packed_symbol: string too long");
+        if (err == std::errc::invalid_argument)
+            throw std::invalid_argument("packed_symbol: character cannot be packed");
+    }
+
+    // Bytes pack as the string's own words, byte swapped on little-endian
+    // targets.
+    template<std::size_t M>
+    std::errc assign_fixed(const fixed_string<M, char>& s, std::true_type) noexcept
+    {
+        const size_type n = details::str_length<M>(s.data(), details::str_simd<char>{});
+        if (n > N)
+            return std::errc::value_too_large;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+        for (size_type k = 0; k != words; ++k)
+            words_[k] = 8 * k < M ? to_big_endian(details::str_word<M>(p, 8 * k, n)) : 0;
+        return std::errc{};
+    }
+
+    template<std::size_t M>
+    std::errc assign_fixed(const fixed_string<M, char>& s, std::false_type) noexcept
+    {
+        return assign(s.data(), M);
+    }
+
+    static std::uint64_t to_big_endian(std::uint64_t w) noexcept
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return w;
+#else
+        return __builtin_bswap64(w);
+#endif
+    }
+
+private:
+    std::uint64_t words_[words] = { 0 };
+};
+
+template<std::size_t N, typename P>
+std::ostream& operator<<(std::ostream& s, const packed_symbol<N, P>& src)
+{
+    return s << src.unpack();
+}
+
+} // namespace ash
+
+namespace std {
+
+template<std::size_t N, typename P>
+struct hash<ash::packed_symbol<N, P>>
+{
+    std::size_t operator()(const ash::packed_symbol<N, P>& src) const noexcept
+    {
+        std::uint64_t h = src.word(0);
+        if (ash::packed_symbol<N, P>::words == 2)
+            h ^= (src.word(1) >> 29 | src.word(1) << 35) * 0xbf58476d1ce4e5b9ull;
+        h *= 0x9e3779b97f4a7c15ull;
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+};
+
+} // namespace std
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ash {
+
+namespace details {
+
+constexpr
+std::size_t round_up(std::size_t n, std::size_t align)
+{
+    return ((n + align - 1) / align) * align;
+}
+
+inline
+std::size_t page_size()
+{
+    static const std::size_t sz = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return sz;
+}
+
+} // namespace details
+
+// Upstream allocators hand out raw, uninitialized memory:
+//   void* allocate(std::size_t bytes, std::size_t align);
+//   void deallocate(void* ptr, std::size_t bytes, std::size_t align);
+
+struct heap_alloc
+{
+    void* allocate(std::size_t bytes, std::size_t align)
+    {
+        if (align <= alignof(std::max_align_t))
+            return ::operator new(bytes);
+        void* ptr = nullptr;
+        if (::posix_memalign(&ptr, align, bytes) != 0)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    void deallocate(void* ptr, std::size_t, std::size_t align) noexcept
+    {
+        if (align <= alignof(std::max_align_t))
+            ::operator delete(ptr);
+        else
+            std::free(ptr);
+    }
+};
+
+// Anonymous private mappings. Mappings of at least huge_threshold bytes are
+// aligned to, and advised to be backed by, transparent huge pages.
+class mmap_alloc
+{
+public:
+    static const constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+public:
+    explicit mmap_alloc(
+            bool huge_pages = true,
+            std::size_t huge_threshold = huge_page_size) :
+        huge_pages_{huge_pages},
+        huge_threshold_{huge_threshold}
+    { }
+
+    void* allocate(std::size_t bytes, std::size_t align)
+    {
+        assert(align <= details::page_size());
+        (void) align;
+        const std::size_t len = mapped_length(bytes);
+        if (not use_huge_pages(len))
+            return map(len);
+
+        // Over-map so the range can be trimmed to a huge page boundary.
+        char* const raw = static_cast<char*>(map(len + huge_page_size));
+        char* const ptr = reinterpret_cast<char*>(details::round_up(
+                    reinterpret_cast<std::uintptr_t>(raw), huge_page_size));
+        if (ptr != raw)
+            ::munmap(raw, ptr - raw);
+        ::munmap(ptr + len, (raw + huge_page_size) - ptr);
+#ifdef MADV_HUGEPAGE
+        ::madvise(ptr, len, MADV_HUGEPAGE);
+#endif
+        return ptr;
+    }
+
+    void deallocate(void* ptr, std::size_t bytes, std::size_t) noexcept
+    {
+        ::munmap(ptr, mapped_length(bytes));
+    }
+
+    bool use_huge_pages(std::size_t bytes) const noexcept
+    {
+        return huge_pages_ and bytes >= huge_threshold_;
+    }
+
+private:
+    std::size_t mapped_length(std::size_t bytes) const noexcept
+    {
+        const std::size_t len = details::round_up(bytes, details::page_size());
+        return use_huge_pages(len) ?
+            details::round_up(len, huge_page_size) : len;
+    }
+
+    static
+    void* map(std::size_t len)
+    {
+        void* ptr = ::mmap(
+                nullptr, len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+private:
+    bool huge_pages_;
+    std::size_t huge_threshold_;
+};
+
+} // namespace ash
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "block_runner.h"
+#include "fixed_decimal.h"
+#include "span.h"
+#include "tmp_buffer.h"
+
+namespace ash {
+
+namespace details {
+
+// Maps keys to unsigned integers with the same ordering. Flipping the sign
+// bit moves negative values below positive ones.
+template<class T, class = void>
+struct radix_traits;
+
+template<class T>
+struct radix_traits<T, std::enable_if_t<std::is_integral<T>::value>>
+{
+    static_assert(not std::is_same<T, bool>::value, "Cannot sort bool keys.");
+
+    using key_type = std::make_unsigned_t<T>;
+
+    static constexpr
+    key_type key(T v) noexcept
+    {
+        return static_cast<key_type>(v) ^ (std::is_signed<T>::value ?
+            static_cast<key_type>(key_type(1) << (sizeof(T) * 8 - 1)) : 0);
+    }
+};
+
+template<unsigned char E, typename IntegerT>
+struct radix_traits<fixed_decimal<E, IntegerT>>
+{
+    using key_type = typename radix_traits<IntegerT>::key_type;
+
+    static constexpr
+    key_type key(fixed_decimal<E, IntegerT> v) noexcept
+    {
+        return radix_traits<IntegerT>::key(v.raw_value());
+    }
+};
+
+template<class K, class Index>
+struct keyed_index
+{
+    K key;
+    Index index;
+};
+
+// Below this size a comparison sort wins.
+constexpr std::size_t radix_min_size = 256;
+
+// Stable LSD radix sort of n elements, one byte per pass. Passes whose byte
+// is shared by every key are skipped. Blocks of src are histogrammed and
+// scattered by separate threads, each writing to its own bucket ranges.
+// Returns whichever of src and tmp holds the result.
+template<class T, class KeyFn>
+T* radix_passes(T* src, T* tmp, std::size_t n, KeyFn key, unsigned n_threads)
+{
+    using K = decltype(key(*src));
+    constexpr unsigned digits = sizeof(K);
+    using histogram = std::array<std::size_t, 256>;
+
+    const block_runner run{n, n_threads};
+    std::vector<std::array<histogram, digits>> counts(run.blocks());
+    run([&](std::size_t b, std::size_t first, std::size_t last) {
+        auto& h = counts[b];
+        for (std::size_t i = first; i != last; ++i) {
+            const K k = key(src[i]);
+            for (unsigned d = 0; d != digits; ++d)
+                h[d][(k >> (8 * d)) & 0xFF] += 1;
+        }
+    });
+
+    std::vector<histogram> offsets(run.blocks());
+    bool permuted = false;
+    for (unsigned d = 0; d != digits; ++d) {
+        const unsigned shift = 8 * d;
+        histogram total{};
+        for (const auto& h : counts) {
+            for (unsigned v = 0; v != 256; ++v)
+                total[v] += h[d][v];
+        }
+        if (total[(key(src[0]) >> shift) & 0xFF] == n)
+            continue;
+
+        // Block counts from the first pass are stale once src is permuted.
+        if (permuted and run.blocks() > 1) {
+            run([&](std::size_t b, std::size_t first, std::size_t last) {
+                auto& h = counts[b][d];
+                h.fill(0);
+                for (std::size_t i = first; i != last; ++i)
+                    h[(key(src[i]) >> shift) & 0xFF] += 1;
+            });
+        }
+
+        std::size_t base = 0;
+        for (unsigned v = 0; v != 256; ++v) {
+            for (std::size_t b = 0; b != run.blocks(); ++b) {
+                offsets[b][v] = base;
+                base += counts[b][d][v];
+            }
+        }
+
+        run([&](std::size_t b, std::size_t first, std::size_t last) {
+            auto& pos = offsets[b];
+            for (std::size_t i = first; i != last; ++i)
+                tmp[pos[(key(src[i]) >> shift) & 0xFF]++] = src[i];
+        });
+        std::swap(src, tmp);
+        permuted = true;
+    }
+    return src;
+}
+
+} // namespace details
+
+// Sorts integers or fixed_decimal values in ascending order with an LSD
+// radix sort on their raw values. Scratch space for a copy of xs is taken
+// from unique_tmp_buffer. With n_threads > 1, large inputs are split across
+// threads, see details::block_runner.
+template<class T>
+void radix_sort(span<T> xs, unsigned n_threads = 1)
+{
+    using traits = details::radix_traits<T>;
+    static_assert(
+            std::is_trivially_copyable<T>::value,
+            "Keys must be trivially copyable.");
+
+    const std::size_t n = xs.size();
+    if (n < details::radix_min_size) {
+        std::sort(xs.begin(), xs.end(), [](const T& a, const T& b) {
+            return traits::key(a) < traits::key(b);
+        });
+        return;
+    }
+
+    simd_tmp_buffer<T> tmp{static_cast<std::ptrdiff_t>(n)};
+    if (not tmp)
+        throw std::bad_alloc();
+    const T* out = details::radix_passes(
+            xs.data(), tmp.data(), n,
+            [](const T& v) { return traits::key(v); }, n_threads);
+    if (out != xs.data())
+        std::copy(out, out + n, xs.data());
+}
+
+// Writes to out the indices that stably sort keys, so keys[out[0]] is the
+// smallest key and equal keys keep their relative order.
+template<class T, class Index>
+void radix_argsort(span<T> keys, span<Index> out, unsigned n_threads = 1)
+{
+    using traits = details::radix_traits<std::remove_const_t<T>>;
+    using K = typename traits::key_type;
+    using entry = details::keyed_index<K, Index>;
+    static_assert(std::is_integral<Index>::value, "Index must be integral.");
+
+    const std::size_t n = keys.size();
+    assert(out.size() >= n);
+    assert(n == 0 or n - 1 <= static_cast<std::make_unsigned_t<Index>>(
+                std::numeric_limits<Index>::max()));
+
+    if (n < details::radix_min_size) {
+        for (std::size_t i = 0; i != n; ++i)
+            out[i] = static_cast<Index>(i);
+        std::stable_sort(out.begin(), out.begin() + n, [&](Index a, Index b) {
+            return traits::key(keys[a]) < traits::key(keys[b]);
+        });
+        return;
+    }
+
+    simd_tmp_buffer<entry> buf{static_cast<std::ptrdiff_t>(2 * n)};
+    if (not buf)
+        throw std::bad_alloc();
+    for (std::size_t i = 0; i != n; ++i)
+        buf[i] = entry{traits::key(keys[i]), static_cast<Index>(i)};
+    const entry* sorted = details::radix_passes(
+            buf.data(), buf.data() + n, n,
+            [](const entry& e) { return e.key; }, n_threads);
+    for (std::size_t i = 0; i != n; ++i)
+        out[i] = sorted[i].index;
+}
+
+} // namespace ash
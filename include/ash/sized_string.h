@@ -0,0 +1,463 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "compare_base.h"
+#include "fixed_string.h"
+#include "string_kernels.h"
+
+namespace ash {
+
+// A fixed_string that knows its length. The slot after the last character
+// holds the remaining capacity, which is zero, and so the terminator, once
+// the string is full. size(), append() and comparisons therefore never scan
+// for the end. Characters past size() are kept zero.
+template<std::size_t Capacity, typename CharT = char>
+class sized_string : compareable<sized_string<Capacity, CharT>>
+{
+private:
+    using traits = std::char_traits<CharT>;
+    using uchar_type = std::make_unsigned_t<CharT>;
+    using simd = details::str_simd<CharT>;
+
+    static_assert(
+            Capacity <= std::numeric_limits<uchar_type>::max(),
+            "Capacity must fit in a single character.");
+
+public:
+    using value_type = CharT;
+    using size_type = std::size_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = CharT*;
+    using const_pointer = const CharT*;
+    using iterator = CharT*;
+    using const_iterator = const CharT*;
+
+    static const constexpr size_type npos = static_cast<size_type>(-1);
+
+public:
+    constexpr sized_string() noexcept
+    {
+        set_size(0);
+    }
+
+    constexpr sized_string(const CharT* s, size_type count) noexcept :
+        sized_string()
+    {
+        size_type n = 0;
+        while (n != Capacity and n != count and s[n] != CharT()) {
+            data_[n] = s[n];
+            ++n;
+        }
+        set_size(n);
+    }
+
+    constexpr sized_string(const CharT* s) noexcept :
+        sized_string(s, Capacity)
+    { }
+
+    constexpr sized_string(size_type count, CharT ch) noexcept :
+        sized_string()
+    {
+        const size_type n = std::min(count, Capacity);
+        for (size_type i = 0; i != n; ++i)
+            data_[i] = ch;
+        set_size(n);
+    }
+
+    template<typename Allocator>
+    sized_string(const std::basic_string<CharT, Allocator>& src) noexcept :
+        sized_string(src.data(), src.size())
+    { }
+
+    template<std::size_t M>
+    explicit sized_string(const fixed_string<M, CharT>& src) noexcept :
+        sized_string(src.data(), src.size())
+    { }
+
+    //
+    // Element access
+    //
+
+    constexpr       reference operator[](size_type pos)       { return data_[pos]; }
+    constexpr const_reference operator[](size_type pos) const { return data_[pos]; }
+
+    constexpr       reference front()       { return data_[0]; }
+    constexpr const_reference front() const { return data_[0]; }
+    constexpr       reference back()        { return data_[size() - 1]; }
+    constexpr const_reference back() const  { return data_[size() - 1]; }
+
+    std::basic_string<CharT> str() const
+    {
+        return std::basic_string<CharT>(data_, size());
+    }
+
+    constexpr const CharT* c_str() const    { return data_; }
+    constexpr const CharT* data() const     { return data_; }
+
+    //
+    // Iterators
+    //
+
+    constexpr iterator          begin()         { return data_; }
+    constexpr const_iterator    begin() const   { return data_; }
+    constexpr const_iterator    cbegin() const  { return data_; }
+    constexpr iterator          end()           { return data_ + size(); }
+    constexpr const_iterator    end() const     { return data_ + size(); }
+    constexpr const_iterator    cend() const    { return data_ + size(); }
+
+    //
+    // Capacity
+    //
+
+    constexpr
+    size_type size() const noexcept
+    {
+        return Capacity - static_cast<uchar_type>(data_[Capacity]);
+    }
+
+    constexpr size_type length() const noexcept { return size(); }
+    constexpr bool      empty() const noexcept  { return size() == 0; }
+    constexpr size_type available() const noexcept
+    {
+        return static_cast<uchar_type>(data_[Capacity]);
+    }
+    static
+    constexpr size_type capacity() { return Capacity; }
+    static
+    constexpr size_type max_size() { return Capacity; }
+
+    //
+    // Operations
+    //
+
+    void swap(sized_string& src) noexcept
+    {
+        std::swap(src.data_, data_);
+    }
+
+    void clear() noexcept
+    {
+        traits::assign(data_, size(), CharT());
+        set_size(0);
+    }
+
+    void push_back(CharT ch) noexcept
+    {
+        append(ch);
+    }
+
+    void pop_back() noexcept
+    {
+        assert(not empty());
+        const size_type n = size() - 1;
+        data_[n] = CharT();
+        set_size(n);
+    }
+
+    // Appends characters of s up to count, its terminator or the capacity,
+    // whichever comes first.
+    sized_string& append(const CharT* s, size_type count) noexcept
+    {
+        const size_type n = size();
+        count = std::min(count, Capacity - n);
+        if (const CharT* nul = traits::find(s, count, CharT()))
+            count = static_cast<size_type>(nul - s);
+        traits::copy(data_ + n, s, count);
+        set_size(n + count);
+        return *this;
+    }
+
+    sized_string& append(const CharT* s) noexcept
+    {
+        return append(s, Capacity);
+    }
+
+    sized_string& append(size_type count, CharT ch) noexcept
+    {
+        const size_type n = size();
+        count = std::min(count, Capacity - n);
+        traits::assign(data_ + n, count, ch);
+        set_size(n + count);
+        return *this;
+    }
+
+    sized_string& append(CharT ch) noexcept
+    {
+        return append(1, ch);
+    }
+
+    template<std::size_t M>
+    sized_string& append(const sized_string<M, CharT>& s) noexcept
+    {
+        return append(s.data(), s.size());
+    }
+
+    template<std::size_t M>
+    sized_string& append(const fixed_string<M, CharT>& s) noexcept
+    {
+        return append(s.data(), s.size());
+    }
+
+    template<typename Allocator>
+    sized_string& append(const std::basic_string<CharT, Allocator>& s) noexcept
+    {
+        return append(s.data(), s.size());
+    }
+
+    // Numbers are formatted as in fixed_string: all digits or nothing, with
+    // std::length_error thrown or, from try_append(), the error returned.
+    template<typename IntegerT, details::enable_if_number_t<IntegerT> = 0>
+    sized_string& append(IntegerT value)
+    {
+        return checked(try_append(value));
+    }
+
+    template<unsigned char E, typename IntegerT>
+    sized_string& append(
+            const fixed_decimal<E, IntegerT>& value,
+            trailing_zeros zeros = trailing_zeros::keep)
+    {
+        return checked(try_append(value, zeros));
+    }
+
+    sized_string& append(
+            double value, unsigned places = 6,
+            trailing_zeros zeros = trailing_zeros::keep)
+    {
+        return checked(try_append(value, places, zeros));
+    }
+
+    template<typename IntegerT, details::enable_if_number_t<IntegerT> = 0>
+    std::errc try_append(IntegerT value) noexcept
+    {
+        return format_back([value](char* first, char* last) {
+            return ash::to_chars(first, last, value);
+        });
+    }
+
+    template<unsigned char E, typename IntegerT>
+    std::errc try_append(
+            const fixed_decimal<E, IntegerT>& value,
+            trailing_zeros zeros = trailing_zeros::keep) noexcept
+    {
+        return format_back([&value, zeros](char* first, char* last) {
+            return ash::to_chars(first, last, value, zeros);
+        });
+    }
+
+    std::errc try_append(
+            double value, unsigned places = 6,
+            trailing_zeros zeros = trailing_zeros::keep) noexcept
+    {
+        return format_back([=](char* first, char* last) {
+            return ash::to_chars(first, last, value, places, zeros);
+        });
+    }
+
+    template<typename Arg>
+    sized_string& operator+=(Arg&& arg)
+        noexcept(noexcept(std::declval<sized_string&>().append(
+                        std::forward<Arg>(arg))))
+    {
+        return append(std::forward<Arg>(arg));
+    }
+
+    size_type find(CharT ch, size_type pos = 0) const noexcept
+    {
+        return details::str_find<Capacity>(data_, size(), ch, pos, simd{});
+    }
+
+    size_type find(const CharT* s, size_type pos = 0) const noexcept
+    {
+        return details::str_find<Capacity>(
+                data_, size(), s, traits::length(s), pos, simd{});
+    }
+
+    size_type rfind(CharT ch, size_type pos = npos) const noexcept
+    {
+        return details::str_rfind<Capacity>(data_, size(), ch, pos, simd{});
+    }
+
+    size_type rfind(const CharT* s, size_type pos = npos) const noexcept
+    {
+        return details::str_rfind<Capacity>(
+                data_, size(), s, traits::length(s), pos, simd{});
+    }
+
+    size_type find_first_of(CharT ch, size_type pos = 0) const noexcept
+    {
+        return find(ch, pos);
+    }
+
+    size_type find_first_of(const CharT* s, size_type pos = 0) const noexcept
+    {
+        return details::str_find_first_of<Capacity>(
+                data_, size(), s, traits::length(s), pos, simd{});
+    }
+
+    //
+    // Comparison
+    //
+
+    // The tails are zero, so equal strings have equal buffers.
+    bool operator==(const sized_string& rhs) const noexcept
+    {
+        constexpr size_type n = Capacity + 1;
+        return details::str_mismatch<n, n>(data_, rhs.data_, n, simd{}) == n;
+    }
+
+    template<std::size_t M>
+    bool operator==(const sized_string<M, CharT>& rhs) const noexcept
+    {
+        return equal(rhs.data(), rhs.size());
+    }
+
+    template<std::size_t M>
+    bool operator==(const fixed_string<M, CharT>& rhs) const noexcept
+    {
+        return equal(rhs.data(), rhs.size());
+    }
+
+    template<typename Allocator>
+    bool operator==(const std::basic_string<CharT, Allocator>& rhs) const noexcept
+    {
+        return equal(rhs.data(), rhs.size());
+    }
+
+    bool operator==(const CharT* rhs) const noexcept
+    {
+        // Stops at the first difference, which is at or before the end of
+        // rhs, so rhs is not read past its terminator.
+        const size_type n = size();
+        for (size_type i = 0; i <= n; ++i) {
+            if (data_[i] != rhs[i])
+                return false;
+        }
+        return true;
+    }
+
+    template<std::size_t M>
+    bool operator<(const sized_string<M, CharT>& rhs) const noexcept
+    {
+        const size_type n = std::min(size(), rhs.size());
+        const size_type i = details::str_mismatch<Capacity, M>(
+                data_, rhs.data(), n, simd{});
+        if (i != n)
+            return details::str_uchar(data_[i]) < details::str_uchar(rhs[i]);
+        return n < rhs.size();
+    }
+
+    template<std::size_t M>
+    bool operator<(const fixed_string<M, CharT>& rhs) const noexcept
+    {
+        return less(rhs.data(), rhs.size());
+    }
+
+    template<typename Allocator>
+    bool operator<(const std::basic_string<CharT, Allocator>& rhs) const noexcept
+    {
+        return less(rhs.data(), rhs.size());
+    }
+
+private:
+    constexpr
+    void set_size(size_type n) noexcept
+    {
+        data_[Capacity] = static_cast<CharT>(Capacity - n);
+    }
+
+    template<typename Format>
+    std::errc format_back(Format format) noexcept
+    {
+        static_assert(std::is_same<CharT, char>::value,
+                "Numbers are only formatted as char.");
+        const size_type n = size();
+        const to_chars_result res = format(data_ + n, data_ + Capacity);
+        if (res.ec == std::errc{})
+            set_size(static_cast<size_type>(res.ptr - data_));
+        return res.ec;
+    }
+
+    sized_string& checked(std::errc ec)
+    {
+        if (ec == std::errc::value_too_large)
+            throw std::length_error("sized_string: number does not fit");
+        if (ec != std::errc{})
+            throw std::invalid_argument("sized_string: number not formattable");
+        return *this;
+    }
+
+    bool equal(const CharT* s, size_type n) const noexcept
+    {
+        return size() == n and traits::compare(data_, s, n) == 0;
+    }
+
+    bool less(const CharT* s, size_type n) const noexcept
+    {
+        const size_type len = size();
+        const int r = traits::compare(data_, s, std::min(len, n));
+        return r < 0 or (r == 0 and len < n);
+    }
+
+private:
+    CharT data_[Capacity + 1] = { 0 };
+};
+
+template<std::size_t C, typename CharT>
+const constexpr typename sized_string<C, CharT>::size_type sized_string<C, CharT>::npos;
+
+template<std::size_t C, typename T>
+std::ostream& operator<<(std::ostream& s, const sized_string<C, T>& src)
+{
+    return s << src.c_str();
+}
+
+} // namespace ash
+
+namespace std {
+
+template<std::size_t C, typename CharT>
+struct hash<ash::sized_string<C, CharT>>
+{
+    std::size_t operator()(const ash::sized_string<C, CharT>& src) const
+    {
+        return static_cast<std::size_t>(
+                ash::details::str_hash<C>(src.data(), src.size()));
+    }
+};
+
+template<std::size_t C, typename CharT>
+void swap(ash::sized_string<C, CharT>& lhs, ash::sized_string<C, CharT>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+} // namespace std
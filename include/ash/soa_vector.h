@@ -0,0 +1,405 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "multipart.h"
+#include "packed_multipart.h"
+#include "page_alloc.h"
+#include "span.h"
+
+namespace ash {
+
+namespace details {
+
+template<class... Bs>
+struct all_of : std::true_type { };
+
+template<class B, class... Bs>
+struct all_of<B, Bs...> :
+    std::integral_constant<bool, B::value and all_of<Bs...>::value>
+{ };
+
+template<class T>
+void destroy_at(T* ptr) noexcept
+{
+    ptr->~T();
+}
+
+} // namespace details
+
+// One contiguous, cache line aligned column per type. Rows are kept in sync
+// across columns by every modifier. Types must be distinct and nothrow move
+// constructible.
+template<class... Ts>
+class soa_vector
+{
+private:
+    static_assert(sizeof...(Ts) != 0, "soa_vector needs at least one column.");
+
+    template<std::size_t I>
+    using column_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    template<class T>
+    using index_of = details::part_index<T, Ts...>;
+
+    using indices = std::index_sequence_for<Ts...>;
+
+    template<std::size_t... Is>
+    static constexpr
+    bool distinct(std::index_sequence<Is...>)
+    {
+        const bool found[] = { (index_of<column_type<Is>>::value == Is)... };
+        for (bool f : found) {
+            if (not f)
+                return false;
+        }
+        return true;
+    }
+
+    static_assert(distinct(indices{}), "Column types must be distinct.");
+
+public:
+    using size_type = std::size_t;
+
+    static const constexpr std::size_t column_align = 64;
+    static const constexpr size_type initial_capacity = 16;
+
+public:
+    soa_vector() = default;
+
+    soa_vector(const soa_vector& src)
+    {
+        reserve(src.size());
+        for (size_type i = 0; i != src.size(); ++i)
+            emplace_back(src.template get<Ts>(i)...);
+    }
+
+    soa_vector(soa_vector&& src) noexcept :
+        columns_{std::exchange(src.columns_, std::tuple<Ts*...>{})},
+        size_{std::exchange(src.size_, 0)},
+        capacity_{std::exchange(src.capacity_, 0)}
+    { }
+
+    soa_vector& operator=(soa_vector src) noexcept
+    {
+        swap(src);
+        return *this;
+    }
+
+    ~soa_vector()
+    {
+        clear();
+        deallocate(columns_, capacity_, indices{});
+    }
+
+    void swap(soa_vector& src) noexcept
+    {
+        std::swap(columns_, src.columns_);
+        std::swap(size_, src.size_);
+        std::swap(capacity_, src.capacity_);
+    }
+
+    //
+    // Element access
+    //
+
+    template<class T>
+    T& get(size_type i)
+    {
+        assert(i < size_);
+        return column_data<T>()[i];
+    }
+
+    template<class T>
+    const T& get(size_type i) const
+    {
+        assert(i < size_);
+        return column_data<T>()[i];
+    }
+
+    template<class T>
+    T& at(size_type i)
+    {
+        if (i >= size_)
+            throw std::out_of_range("ash::soa_vector::at");
+        return get<T>(i);
+    }
+
+    template<class T>
+    const T& at(size_type i) const
+    {
+        if (i >= size_)
+            throw std::out_of_range("ash::soa_vector::at");
+        return get<T>(i);
+    }
+
+    template<class T>
+    span<T> column()
+    {
+        return {column_data<T>(), size_};
+    }
+
+    template<class T>
+    span<const T> column() const
+    {
+        return {column_data<T>(), size_};
+    }
+
+    //
+    // Capacity
+    //
+
+    size_type size() const noexcept         { return size_; }
+    size_type capacity() const noexcept     { return capacity_; }
+    bool empty() const noexcept             { return size_ == 0; }
+
+    void reserve(size_type n)
+    {
+        if (n <= capacity_)
+            return;
+        adopt(allocate(n, indices{}), n);
+    }
+
+    //
+    // Modifiers
+    //
+
+    template<class... Args>
+    void emplace_back(Args&&... args)
+    {
+        static_assert(
+                sizeof...(Args) == sizeof...(Ts),
+                "One argument is required per column.");
+        if (size_ == capacity_)
+            grow_emplace(std::forward<Args>(args)...);
+        else
+            construct_row(columns_, size_, indices{}, std::forward<Args>(args)...);
+        ++size_;
+    }
+
+    void push_back(const Ts&... values)
+    {
+        emplace_back(values...);
+    }
+
+    void push_back(Ts&&... values)
+    {
+        emplace_back(std::move(values)...);
+    }
+
+    // Every part of src must be set.
+    template<template<class> class Alloc>
+    void push_back(const basic_multipart<Alloc, Ts...>& src)
+    {
+        emplace_back(src.template get<Ts>()...);
+    }
+
+    void push_back(const packed_multipart<Ts...>& src)
+    {
+        emplace_back(src.template get<Ts>()...);
+    }
+
+    void pop_back() noexcept
+    {
+        assert(size_ != 0);
+        destroy_row(--size_, indices{});
+    }
+
+    // Removes row i, keeping the order of the remaining rows.
+    void erase(size_type i)
+    {
+        assert(i < size_);
+        shift_down(i, indices{});
+        pop_back();
+    }
+
+    // Removes row i in constant time by moving the last row into its place.
+    void swap_erase(size_type i)
+    {
+        assert(i < size_);
+        if (i != size_ - 1)
+            move_row(size_ - 1, i, indices{});
+        pop_back();
+    }
+
+    void clear() noexcept
+    {
+        while (size_ != 0)
+            destroy_row(--size_, indices{});
+    }
+
+private:
+    using expand = int[];
+
+    template<class T>
+    static constexpr
+    std::size_t alignment()
+    {
+        return (alignof(T) > column_align) ? alignof(T) : column_align;
+    }
+
+    template<class T>
+    T* column_data() const noexcept
+    {
+        return std::get<index_of<T>::value>(columns_);
+    }
+
+    template<std::size_t... Is>
+    static
+    std::tuple<Ts*...> allocate(size_type n, std::index_sequence<Is...>)
+    {
+        std::tuple<Ts*...> fresh;
+        try {
+            (void) expand{ 0, (std::get<Is>(fresh) = static_cast<Ts*>(
+                        heap_alloc{}.allocate(
+                            n * sizeof(Ts),
+                            alignment<Ts>())), 0)... };
+        } catch (...) {
+            deallocate(fresh, n, indices{});
+            throw;
+        }
+        return fresh;
+    }
+
+    template<std::size_t... Is>
+    static
+    void deallocate(
+            const std::tuple<Ts*...>& columns,
+            size_type n,
+            std::index_sequence<Is...>) noexcept
+    {
+        (void) expand{ 0, (std::get<Is>(columns) == nullptr ? 0 :
+                (heap_alloc{}.deallocate(
+                    std::get<Is>(columns), n * sizeof(Ts),
+                    alignment<Ts>()), 0))... };
+    }
+
+    // Moves the rows into fresh, which holds n rows, and frees the old
+    // columns.
+    void adopt(const std::tuple<Ts*...>& fresh, size_type n) noexcept
+    {
+        relocate(fresh, indices{});
+        deallocate(columns_, capacity_, indices{});
+        columns_ = fresh;
+        capacity_ = n;
+    }
+
+    // The new row is built before the old rows move, as args may refer to
+    // them. If that throws the vector is unchanged.
+    template<class... Args>
+    void grow_emplace(Args&&... args)
+    {
+        const size_type n = (capacity_ != 0) ? 2 * capacity_ : initial_capacity;
+        const auto fresh = allocate(n, indices{});
+        try {
+            construct_row(fresh, size_, indices{}, std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(fresh, n, indices{});
+            throw;
+        }
+        adopt(fresh, n);
+    }
+
+    template<std::size_t... Is>
+    void relocate(const std::tuple<Ts*...>& fresh, std::index_sequence<Is...>) noexcept
+    {
+        static_assert(
+                details::all_of<std::is_nothrow_move_constructible<Ts>...>::value,
+                "Columns must be nothrow move constructible.");
+        (void) expand{ 0, (relocate_column(
+                    std::get<Is>(columns_), std::get<Is>(fresh)), 0)... };
+    }
+
+    template<class T>
+    void relocate_column(T* src, T* dst) noexcept
+    {
+        for (size_type i = 0; i != size_; ++i) {
+            new (dst + i) T(std::move(src[i]));
+            details::destroy_at(src + i);
+        }
+    }
+
+    template<std::size_t... Is, class... Args>
+    static
+    void construct_row(
+            const std::tuple<Ts*...>& columns, size_type i,
+            std::index_sequence<Is...>, Args&&... args)
+    {
+        std::size_t built = 0;
+        try {
+            (void) expand{ 0, (new (std::get<Is>(columns) + i)
+                    column_type<Is>(std::forward<Args>(args)), ++built, 0)... };
+        } catch (...) {
+            (void) expand{ 0, (Is < built ?
+                    (details::destroy_at(std::get<Is>(columns) + i), 0) :
+                    0)... };
+            throw;
+        }
+    }
+
+    template<std::size_t... Is>
+    void destroy_row(size_type i, std::index_sequence<Is...>) noexcept
+    {
+        (void) expand{ 0, (details::destroy_at(std::get<Is>(columns_) + i), 0)... };
+    }
+
+    template<std::size_t... Is>
+    void shift_down(size_type i, std::index_sequence<Is...>)
+    {
+        (void) expand{ 0, (std::move(
+                    std::get<Is>(columns_) + i + 1,
+                    std::get<Is>(columns_) + size_,
+                    std::get<Is>(columns_) + i), 0)... };
+    }
+
+    template<std::size_t... Is>
+    void move_row(size_type from, size_type to, std::index_sequence<Is...>)
+    {
+        (void) expand{ 0, (std::get<Is>(columns_)[to] =
+                    std::move(std::get<Is>(columns_)[from]), 0)... };
+    }
+
+private:
+    std::tuple<Ts*...> columns_;
+    size_type size_{0};
+    size_type capacity_{0};
+};
+
+template<class M> struct soa_vector_of;
+
+template<template<class> class Alloc, class... Ts>
+struct soa_vector_of<basic_multipart<Alloc, Ts...>>
+{
+    using type = soa_vector<Ts...>;
+};
+
+// The columnar counterpart of a multipart, e.g.
+// soa_vector_of_t<multipart<A, B>> is soa_vector<A, B>.
+template<class M>
+using soa_vector_of_t = typename soa_vector_of<M>::type;
+
+} // namespace ash
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace ash {
+
+// Non-owning view of a contiguous sequence, a subset of C++20 std::span.
+template<class T>
+class span
+{
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+
+    static const constexpr size_type npos = static_cast<size_type>(-1);
+
+public:
+    constexpr span() = default;
+
+    constexpr span(pointer data, size_type size) :
+        data_{data},
+        size_{size}
+    { }
+
+    constexpr span(pointer first, pointer last) :
+        data_{first},
+        size_{static_cast<size_type>(last - first)}
+    { }
+
+    template<std::size_t N>
+    constexpr span(T (&arr)[N]) :
+        data_{arr},
+        size_{N}
+    { }
+
+    template<
+        class Container,
+        typename std::enable_if_t<
+            std::is_convertible<
+                decltype(std::declval<Container&>().data()), pointer
+            >::value, int> = 0>
+    constexpr span(Container& src) :
+        data_{src.data()},
+        size_{src.size()}
+    { }
+
+    template<
+        class U,
+        typename std::enable_if_t<
+            std::is_convertible<U(*)[], T(*)[]>::value, int> = 0>
+    constexpr span(const span<U>& src) :
+        data_{src.data()},
+        size_{src.size()}
+    { }
+
+    constexpr pointer data() const          { return data_; }
+    constexpr size_type size() const        { return size_; }
+    constexpr bool empty() const            { return size_ == 0; }
+
+    constexpr iterator begin() const        { return data_; }
+    constexpr iterator end() const          { return data_ + size_; }
+    constexpr const_iterator cbegin() const { return data_; }
+    constexpr const_iterator cend() const   { return data_ + size_; }
+
+    constexpr reference operator[](size_type i) const
+    {
+        return data_[i];
+    }
+
+    constexpr reference front() const       { return data_[0]; }
+    constexpr reference back() const        { return data_[size_ - 1]; }
+
+    constexpr span first(size_type n) const
+    {
+        return {data_, n};
+    }
+
+    constexpr span last(size_type n) const
+    {
+        return {data_ + (size_ - n), n};
+    }
+
+    constexpr span subspan(size_type offset, size_type count = npos) const
+    {
+        return {data_ + offset, (count == npos) ? size_ - offset : count};
+    }
+
+private:
+    pointer data_{nullptr};
+    size_type size_{0};
+};
+
+template<class T>
+constexpr
+span<T> make_span(T* data, std::size_t size)
+{
+    return {data, size};
+}
+
+template<class Container>
+constexpr
+auto make_span(Container& src)
+{
+    return span<std::remove_pointer_t<decltype(src.data())>>{src};
+}
+
+} // namespace ash
@@ -17,12 +17,18 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
-#include <forward_list>
+#include <iterator>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "page_alloc.h"
 
 namespace ash {
 
@@ -35,10 +41,19 @@ private:
 public:
     using buffer_type = typename std::aligned_storage_t<sizeof(T), alignof(T)>;
     using storage_type = std::array<buffer_type, Capacity>;
+    using value_type = T;
     using reference = T&;
     using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
     using size_type = typename storage_type::size_type;
 
+    static_assert(
+            sizeof(buffer_type) == sizeof(T),
+            "Created objects must be contiguous.");
+
 public:
     ~stable_chunk()
     {
@@ -83,25 +98,253 @@ public:
         return Capacity;
     }
 
+    pointer data() noexcept
+    {
+        return reinterpret_cast<pointer>(storage_.data());
+    }
+
+    const_pointer data() const noexcept
+    {
+        return reinterpret_cast<const_pointer>(storage_.data());
+    }
+
+    iterator begin() noexcept               { return data(); }
+    iterator end() noexcept                 { return data() + index_; }
+    const_iterator begin() const noexcept   { return data(); }
+    const_iterator end() const noexcept     { return data() + index_; }
+    const_iterator cbegin() const noexcept  { return begin(); }
+    const_iterator cend() const noexcept    { return end(); }
+
+    template<typename Func>
+    void for_each(Func&& f)
+    {
+        for (auto& obj : *this)
+            f(obj);
+    }
+
+    template<typename Func>
+    void for_each(Func&& f) const
+    {
+        for (const auto& obj : *this)
+            f(obj);
+    }
+
 private:
     size_type index_{0};
     storage_type storage_;
 };
 
-template<typename T, std::size_t ChunkCapacity>
+// Chunk capacity of a stable_storage whose chunks grow geometrically.
+static const constexpr std::size_t dynamic_chunk = 0;
+
+template<
+    typename T,
+    std::size_t ChunkCapacity = dynamic_chunk,
+    class Upstream = heap_alloc>
 class stable_storage
 {
 public:
-    using chunk_type = stable_chunk<T, ChunkCapacity>;
-    using reference = typename chunk_type::reference;
-    using size_type = typename chunk_type::size_type;
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using size_type = std::size_t;
+    using upstream_type = Upstream;
+
+    static const constexpr bool is_dynamic = (ChunkCapacity == dynamic_chunk);
+
+    // Capacity of the first chunk of a dynamic stable_storage.
+    static const constexpr size_type initial_chunk_capacity =
+        is_dynamic ? std::max<size_type>(4, 512 / sizeof(T)) : ChunkCapacity;
+
+    // Fewest objects parallel_for_each_chunk hands to a thread at once.
+    static const constexpr size_type min_parallel_block =
+        std::max<size_type>(1, 16 * 1024 / sizeof(T));
+
+private:
+    struct chunk_node
+    {
+        chunk_node* next;
+        size_type size;
+        size_type capacity;
+
+        pointer begin() const noexcept
+        {
+            auto* const mem = reinterpret_cast<const char*>(this) + header_size;
+            return reinterpret_cast<pointer>(const_cast<char*>(mem));
+        }
+
+        pointer end() const noexcept        { return begin() + size; }
+        bool full() const noexcept          { return size == capacity; }
+    };
+
+    static const constexpr size_type header_size =
+        details::round_up(sizeof(chunk_node), alignof(T));
+    static const constexpr size_type chunk_align =
+        std::max(alignof(chunk_node), alignof(T));
+
+    // Visits every created object, in order of creation.
+    template<typename V>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<V>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+    public:
+        basic_iterator() = default;
+
+        explicit basic_iterator(const chunk_node* chunk) :
+            chunk_{chunk}
+        {
+            skip_empty();
+        }
+
+        template<typename W>
+        basic_iterator(const basic_iterator<W>& src) :
+            chunk_{src.chunk_},
+            pos_{src.pos_}
+        { }
+
+        reference operator*() const     { return *pos_; }
+        pointer operator->() const      { return pos_; }
+
+        basic_iterator& operator++()
+        {
+            if (++pos_ == chunk_->end()) {
+                chunk_ = chunk_->next;
+                skip_empty();
+            }
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator ret{*this};
+            ++(*this);
+            return ret;
+        }
+
+        template<typename W>
+        bool operator==(const basic_iterator<W>& rhs) const
+        {
+            return pos_ == rhs.pos_;
+        }
+
+        template<typename W>
+        bool operator!=(const basic_iterator<W>& rhs) const
+        {
+            return not (*this == rhs);
+        }
+
+    private:
+        template<typename> friend class basic_iterator;
+
+        void skip_empty()
+        {
+            while (chunk_ != nullptr and chunk_->size == 0)
+                chunk_ = chunk_->next;
+            pos_ = (chunk_ != nullptr) ? chunk_->begin() : nullptr;
+        }
+
+    private:
+        const chunk_node* chunk_{nullptr};
+        pointer pos_{nullptr};
+    };
+
+public:
+    using iterator = basic_iterator<T>;
+    using const_iterator = basic_iterator<const T>;
 
 public:
+    stable_storage() = default;
+
+    explicit stable_storage(const Upstream& upstream) :
+        upstream_{upstream}
+    { }
+
+    stable_storage(stable_storage&& src) :
+        upstream_{src.upstream_},
+        head_{std::exchange(src.head_, nullptr)},
+        tail_{std::exchange(src.tail_, nullptr)},
+        last_{std::exchange(src.last_, nullptr)},
+        size_{std::exchange(src.size_, 0)},
+        capacity_{std::exchange(src.capacity_, 0)},
+        num_chunks_{std::exchange(src.num_chunks_, 0)}
+    { }
+
+    stable_storage(const stable_storage&) = delete;
+    stable_storage& operator=(const stable_storage&) = delete;
+
+    ~stable_storage()
+    {
+        clear();
+        while (head_ != nullptr) {
+            chunk_node* const next = head_->next;
+            upstream_.deallocate(head_, chunk_bytes(head_->capacity), chunk_align);
+            head_ = next;
+        }
+    }
+
     template<typename... Args>
-    reference create(Args&&... args) noexcept
+    reference create(Args&&... args)
     {
         auto& chunk = grab_chunk();
-        return chunk.create(std::forward<Args>(args)...);
+        auto* obj = new (chunk.end()) T(std::forward<Args>(args)...);
+        ++chunk.size;
+        ++size_;
+        return *obj;
+    }
+
+    // Allocates chunks until n objects fit without further allocation.
+    void reserve(size_type n)
+    {
+        size_type spare = 0;
+        for (auto* chunk = tail_ ? tail_ : head_; chunk; chunk = chunk->next)
+            spare += chunk->capacity - chunk->size;
+        if (size_ + spare >= n)
+            return;
+        size_type needed = n - size_ - spare;
+        if (is_dynamic) {
+            append_chunk(std::max(needed, next_chunk_capacity()));
+            return;
+        }
+        while (needed > ChunkCapacity) {
+            append_chunk(ChunkCapacity);
+            needed -= ChunkCapacity;
+        }
+        append_chunk(ChunkCapacity);
+    }
+
+    // Destroys every object. Chunks are kept and reused by create().
+    void clear() noexcept
+    {
+        for (auto* chunk = head_; chunk; chunk = chunk->next) {
+            for (auto& obj : range(chunk))
+                obj.~T();
+            chunk->size = 0;
+        }
+        tail_ = head_;
+        size_ = 0;
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_type capacity() const noexcept
+    {
+        return capacity_;
     }
 
     size_type chunk_count() const noexcept
@@ -112,23 +355,177 @@ public:
     static constexpr
     size_type chunk_capacity()
     {
-        return chunk_type::capacity();
+        return ChunkCapacity;
+    }
+
+    const upstream_type& upstream() const noexcept
+    {
+        return upstream_;
+    }
+
+    //
+    // Iteration
+    //
+
+    iterator begin()                { return iterator{head_}; }
+    iterator end()                  { return iterator{}; }
+    const_iterator begin() const    { return const_iterator{head_}; }
+    const_iterator end() const      { return const_iterator{}; }
+    const_iterator cbegin() const   { return begin(); }
+    const_iterator cend() const     { return end(); }
+
+    template<typename Func>
+    void for_each(Func&& f)
+    {
+        for_each_chunk([&f](pointer first, pointer last) {
+            std::for_each(first, last, f);
+        });
+    }
+
+    template<typename Func>
+    void for_each(Func&& f) const
+    {
+        for_each_chunk([&f](const_pointer first, const_pointer last) {
+            std::for_each(first, last, f);
+        });
+    }
+
+    // Calls f(first, last) with the contiguous range of each chunk.
+    template<typename Func>
+    void for_each_chunk(Func&& f)
+    {
+        for (auto* chunk = head_; chunk; chunk = chunk->next) {
+            if (chunk->size != 0)
+                f(chunk->begin(), chunk->end());
+        }
+    }
+
+    template<typename Func>
+    void for_each_chunk(Func&& f) const
+    {
+        for (const auto* chunk = head_; chunk; chunk = chunk->next) {
+            if (chunk->size != 0)
+                f(const_pointer{chunk->begin()}, const_pointer{chunk->end()});
+        }
+    }
+
+    // Calls f on every object from n_threads threads. f is called
+    // concurrently and must not throw.
+    template<typename Func>
+    void parallel_for_each(
+            Func&& f,
+            unsigned n_threads = std::thread::hardware_concurrency())
+    {
+        parallel_for_each_chunk(
+            [&f](pointer first, pointer last) {
+                std::for_each(first, last, f);
+            },
+            n_threads);
+    }
+
+    // Calls f(first, last) on contiguous blocks of about size() / n_threads
+    // objects, but at least min_parallel_block, cut from each chunk. A single
+    // reserved chunk is thus still shared between the threads.
+    template<typename Func>
+    void parallel_for_each_chunk(
+            Func&& f,
+            unsigned n_threads = std::thread::hardware_concurrency())
+    {
+        n_threads = std::max(1u, n_threads);
+        const size_type block = std::max(
+            size_type{min_parallel_block}, (size_ + n_threads - 1) / n_threads);
+
+        std::vector<chunk_range> work;
+        work.reserve(num_chunks_ + size_ / block);
+        for (auto* chunk = head_; chunk; chunk = chunk->next) {
+            for (pointer first = chunk->begin(); first != chunk->end();) {
+                const auto left = static_cast<size_type>(chunk->end() - first);
+                const pointer last = first + std::min(block, left);
+                work.push_back({first, last});
+                first = last;
+            }
+        }
+
+        std::atomic<size_type> next{0};
+        auto worker = [&] {
+            for (auto i = next++; i < work.size(); i = next++)
+                f(work[i].first, work[i].last);
+        };
+
+        n_threads = std::min<size_type>(n_threads, work.size());
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < n_threads; ++i)
+            threads.emplace_back(worker);
+        worker();
+        for (auto& thd : threads)
+            thd.join();
     }
 
 private:
-    chunk_type& grab_chunk() noexcept
+    struct chunk_range
+    {
+        pointer first;
+        pointer last;
+        pointer begin() const { return first; }
+        pointer end() const { return last; }
+    };
+
+    static
+    chunk_range range(const chunk_node* chunk) noexcept
+    {
+        return {chunk->begin(), chunk->end()};
+    }
+
+    static constexpr
+    size_type chunk_bytes(size_type capacity)
+    {
+        return header_size + capacity * sizeof(T);
+    }
+
+    size_type next_chunk_capacity() const noexcept
+    {
+        if (not is_dynamic)
+            return ChunkCapacity;
+        return (capacity_ > initial_chunk_capacity) ?
+            capacity_ : initial_chunk_capacity;
+    }
+
+    chunk_node& grab_chunk()
+    {
+        if (tail_ == nullptr) {
+            if (head_ == nullptr)
+                append_chunk(next_chunk_capacity());
+            tail_ = head_;
+        }
+        while (tail_->full()) {
+            if (tail_->next == nullptr)
+                append_chunk(next_chunk_capacity());
+            tail_ = tail_->next;
+        }
+        return *tail_;
+    }
+
+    void append_chunk(size_type capacity)
     {
-        auto& chunk = chunks_.front();
-        if (not chunk.full())
-            return chunk;
-        chunks_.emplace_front();
+        void* mem = upstream_.allocate(chunk_bytes(capacity), chunk_align);
+        auto* chunk = new (mem) chunk_node{nullptr, 0, capacity};
+        if (last_ != nullptr)
+            last_->next = chunk;
+        else
+            head_ = chunk;
+        last_ = chunk;
+        capacity_ += capacity;
         ++num_chunks_;
-        return grab_chunk();
     }
 
 private:
-    std::forward_list<chunk_type> chunks_{1};
-    size_type num_chunks_{1};
+    Upstream upstream_{};
+    chunk_node* head_{nullptr};
+    chunk_node* tail_{nullptr};
+    chunk_node* last_{nullptr};
+    size_type size_{0};
+    size_type capacity_{0};
+    size_type num_chunks_{0};
 };
 
 } // namespace ash
@@ -0,0 +1,462 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ASH_STRING_SIMD 1
+#else
+#define ASH_STRING_SIMD 0
+#endif
+
+namespace ash {
+
+namespace details {
+
+// Search and comparison over inline character buffers whose size N is known
+// at compile time, as in fixed_string and sized_string. Every function reads
+// only [p, p + N) and looks at the first n characters. With SSE2 narrow
+// characters are handled 16 at a time, otherwise one at a time.
+
+static const constexpr std::size_t str_npos = static_cast<std::size_t>(-1);
+
+template<typename CharT>
+using str_simd = std::integral_constant<bool,
+      ASH_STRING_SIMD and sizeof(CharT) == 1 and std::is_integral<CharT>::value>;
+
+template<typename CharT>
+constexpr std::make_unsigned_t<CharT> str_uchar(CharT ch) noexcept
+{
+    return static_cast<std::make_unsigned_t<CharT>>(ch);
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_length(const CharT* p, std::false_type) noexcept
+{
+    std::size_t i = 0;
+    while (i != N and p[i] != CharT()) ++i;
+    return i;
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_find(
+        const CharT* p, std::size_t n, CharT ch, std::size_t pos,
+        std::false_type) noexcept
+{
+    for (std::size_t i = pos; i < n; ++i) {
+        if (p[i] == ch)
+            return i;
+    }
+    return str_npos;
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_rfind(
+        const CharT* p, std::size_t n, CharT ch, std::size_t pos,
+        std::false_type) noexcept
+{
+    if (n == 0)
+        return str_npos;
+    for (std::size_t i = std::min(pos, n - 1) + 1; i-- != 0;) {
+        if (p[i] == ch)
+            return i;
+    }
+    return str_npos;
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_find_first_of(
+        const CharT* p, std::size_t n, const CharT* s, std::size_t m,
+        std::size_t pos, std::false_type) noexcept
+{
+    for (std::size_t i = pos; i < n; ++i) {
+        if (std::char_traits<CharT>::find(s, m, p[i]))
+            return i;
+    }
+    return str_npos;
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_find(
+        const CharT* p, std::size_t n, const CharT* s, std::size_t m,
+        std::size_t pos, std::false_type) noexcept
+{
+    if (m > n or pos > n - m)
+        return str_npos;
+    for (std::size_t i = pos; i <= n - m; ++i) {
+        if (std::char_traits<CharT>::compare(p + i, s, m) == 0)
+            return i;
+    }
+    return str_npos;
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_rfind(
+        const CharT* p, std::size_t n, const CharT* s, std::size_t m,
+        std::size_t pos, std::false_type) noexcept
+{
+    if (m > n)
+        return str_npos;
+    for (std::size_t i = std::min(pos, n - m) + 1; i-- != 0;) {
+        if (std::char_traits<CharT>::compare(p + i, s, m) == 0)
+            return i;
+    }
+    return str_npos;
+}
+
+// Index of the first difference in the first n characters, or n.
+template<std::size_t N, std::size_t M, typename CharT>
+std::size_t str_mismatch(
+        const CharT* a, const CharT* b, std::size_t n,
+        std::false_type) noexcept
+{
+    std::size_t i = 0;
+    while (i != n and a[i] == b[i]) ++i;
+    return i;
+}
+
+// Compares two buffers holding strings that end at their first null
+// character, or at the end of the buffer.
+template<std::size_t N, std::size_t M, typename CharT>
+int str_compare(const CharT* a, const CharT* b, std::false_type) noexcept
+{
+    const std::size_t n = std::min(N, M);
+    for (std::size_t i = 0; i != n; ++i) {
+        if (a[i] != b[i])
+            return str_uchar(a[i]) < str_uchar(b[i]) ? -1 : 1;
+        if (a[i] == CharT())
+            return 0;
+    }
+    if (N > M)
+        return a[n] != CharT();
+    if (N < M)
+        return -(b[n] != CharT());
+    return 0;
+}
+
+// Hashing in the style of wyhash: eight bytes at a time, each pair folded in
+// with one 64 x 64 -> 128-bit multiply. Only the first n characters count,
+// so anything stored past the end of the string does not change the hash.
+
+static const constexpr std::uint64_t str_hash_k0 = 0xa0761d6478bd642full;
+static const constexpr std::uint64_t str_hash_k1 = 0xe7037ed1a0b428dbull;
+
+inline std::uint64_t str_hash_mix(std::uint64_t a, std::uint64_t b) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 wide;
+    const wide r = static_cast<wide>(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+    const std::uint64_t lo_lo = (a & 0xffffffff) * (b & 0xffffffff);
+    const std::uint64_t hi_lo = (a >> 32) * (b & 0xffffffff);
+    const std::uint64_t lo_hi = (a & 0xffffffff) * (b >> 32);
+    const std::uint64_t hi_hi = (a >> 32) * (b >> 32);
+    const std::uint64_t t = hi_lo + (lo_lo >> 32);
+    const std::uint64_t u = (t & 0xffffffff) + lo_hi;
+    const std::uint64_t hi = hi_hi + (t >> 32) + (u >> 32);
+    return (a * b) ^ hi;
+#endif
+}
+
+// The eight bytes at p + off, of which those at or past p + n read as zero.
+// Never reads at or past p + Size.
+template<std::size_t Size>
+inline std::uint64_t str_word(
+        const unsigned char* p, std::size_t off, std::size_t n) noexcept
+{
+    std::uint64_t w = 0;
+    if (Size >= 8) {
+        // Near the end, loads the last eight bytes and shifts out the extra.
+        const std::size_t at = std::min(off, Size - 8);
+        std::memcpy(&w, p + at, 8);
+        const unsigned skip = static_cast<unsigned>(off - at) * 8;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        w <<= skip;
+#else
+        w >>= skip;
+#endif
+    } else {
+        assert(off == 0);
+        std::memcpy(&w, p, Size);
+    }
+    // Keeps the first k bytes without branching on k.
+    const std::uint64_t past = (n - off) & (std::uint64_t(0) - (n > off));
+    const std::uint64_t k = std::min<std::uint64_t>(past, 8);
+    std::uint64_t keep =
+        ((std::uint64_t(1) << (k * 8 & 63)) - 1) | (std::uint64_t(0) - (k >> 3));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    keep = __builtin_bswap64(keep);
+#endif
+    return w & keep;
+}
+
+// Strings of up to 16 bytes, and the last 1 to 16 bytes of longer ones, are
+// folded in as two words. With a capacity of at most 16 bytes there is no
+// branch on the length at all.
+template<std::size_t N, typename CharT>
+inline std::uint64_t str_hash(const CharT* src, std::size_t n) noexcept
+{
+    constexpr std::size_t size = N * sizeof(CharT);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(src);
+    const std::size_t bytes = n * sizeof(CharT);
+
+    std::uint64_t seed = str_hash_k0 ^ bytes;
+    std::size_t off = 0;
+    if (size > 16) {
+        for (; off + 16 < bytes; off += 16) {
+            seed = str_hash_mix(
+                    str_word<size>(p, off, bytes) ^ str_hash_k1,
+                    str_word<size>(p, off + 8, bytes) ^ seed);
+        }
+    }
+    const std::uint64_t a = str_word<size>(p, off, bytes);
+    const std::uint64_t b =
+        off + 8 < size ? str_word<size>(p, off + 8, bytes) : 0;
+    return str_hash_mix(
+            str_hash_k1 ^ bytes,
+            str_hash_mix(a ^ str_hash_k1, b ^ seed));
+}
+
+#if ASH_STRING_SIMD
+
+// Loads the 16 bytes at p + off. Bytes at or past p + N read as zero.
+template<std::size_t N>
+inline __m128i str_load(const char* p, std::size_t off) noexcept
+{
+    if (N >= 16 and off <= N - 16)
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + off));
+    alignas(16) char tmp[16] = { 0 };
+    if (off < N)
+        std::memcpy(tmp, p + off, N - off);
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(tmp));
+}
+
+inline unsigned str_eq_mask(__m128i v, __m128i w) noexcept
+{
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, w)));
+}
+
+inline unsigned str_eq_mask(__m128i v, char ch) noexcept
+{
+    return str_eq_mask(v, _mm_set1_epi8(ch));
+}
+
+// Bits of the block at off that fall in [lo, hi).
+inline unsigned str_range(std::size_t off, std::size_t lo, std::size_t hi) noexcept
+{
+    const std::size_t l = lo > off ? std::min<std::size_t>(lo - off, 16) : 0;
+    const std::size_t h = hi > off ? std::min<std::size_t>(hi - off, 16) : 0;
+    return ((1u << h) - 1) & ~((1u << l) - 1);
+}
+
+inline std::size_t str_first(unsigned mask) noexcept
+{
+    return static_cast<std::size_t>(__builtin_ctz(mask));
+}
+
+inline std::size_t str_last(unsigned mask) noexcept
+{
+    return static_cast<std::size_t>(31 - __builtin_clz(mask));
+}
+
+template<typename CharT>
+const char* str_bytes(const CharT* p) noexcept
+{
+    return reinterpret_cast<const char*>(p);
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_length(const CharT* src, std::true_type) noexcept
+{
+    const char* p = str_bytes(src);
+    for (std::size_t off = 0; off < N; off += 16) {
+        const unsigned m = str_eq_mask(str_load<N>(p, off), '\0') & str_range(off, 0, N);
+        if (m)
+            return off + str_first(m);
+    }
+    return N;
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_find(
+        const CharT* src, std::size_t n, CharT ch, std::size_t pos,
+        std::true_type) noexcept
+{
+    const char* p = str_bytes(src);
+    for (std::size_t off = pos & ~std::size_t(15); off < n; off += 16) {
+        const unsigned m =
+            str_eq_mask(str_load<N>(p, off), static_cast<char>(ch)) &
+            str_range(off, pos, n);
+        if (m)
+            return off + str_first(m);
+    }
+    return str_npos;
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_rfind(
+        const CharT* src, std::size_t n, CharT ch, std::size_t pos,
+        std::true_type) noexcept
+{
+    if (n == 0)
+        return str_npos;
+    const char* p = str_bytes(src);
+    const std::size_t end = std::min(pos, n - 1) + 1;
+    for (std::size_t off = (end - 1) & ~std::size_t(15);; off -= 16) {
+        const unsigned m =
+            str_eq_mask(str_load<N>(p, off), static_cast<char>(ch)) &
+            str_range(off, 0, end);
+        if (m)
+            return off + str_last(m);
+        if (off == 0)
+            return str_npos;
+    }
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_find_first_of(
+        const CharT* src, std::size_t n, const CharT* s, std::size_t m,
+        std::size_t pos, std::true_type) noexcept
+{
+    const char* p = str_bytes(src);
+    for (std::size_t off = pos & ~std::size_t(15); off < n; off += 16) {
+        const __m128i v = str_load<N>(p, off);
+        unsigned hits = 0;
+        for (std::size_t k = 0; k != m; ++k)
+            hits |= str_eq_mask(v, static_cast<char>(s[k]));
+        hits &= str_range(off, pos, n);
+        if (hits)
+            return off + str_first(hits);
+    }
+    return str_npos;
+}
+
+// Candidates must match both the first and the last character of s, which
+// rejects most positions without looking at the rest.
+template<std::size_t N, typename CharT>
+std::size_t str_find(
+        const CharT* src, std::size_t n, const CharT* s, std::size_t m,
+        std::size_t pos, std::true_type) noexcept
+{
+    if (m > n or pos > n - m)
+        return str_npos;
+    if (m == 0)
+        return pos;
+    const char* p = str_bytes(src);
+    const __m128i first = _mm_set1_epi8(static_cast<char>(s[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(s[m - 1]));
+    const std::size_t end = n - m + 1;
+    for (std::size_t off = pos & ~std::size_t(15); off < end; off += 16) {
+        unsigned c =
+            str_eq_mask(str_load<N>(p, off), first) &
+            str_eq_mask(str_load<N>(p, off + m - 1), last) &
+            str_range(off, pos, end);
+        while (c) {
+            const std::size_t i = off + str_first(c);
+            if (std::memcmp(p + i, s, m) == 0)
+                return i;
+            c &= c - 1;
+        }
+    }
+    return str_npos;
+}
+
+template<std::size_t N, typename CharT>
+std::size_t str_rfind(
+        const CharT* src, std::size_t n, const CharT* s, std::size_t m,
+        std::size_t pos, std::true_type) noexcept
+{
+    if (m > n)
+        return str_npos;
+    const std::size_t end = std::min(pos, n - m) + 1;
+    if (m == 0)
+        return end - 1;
+    const char* p = str_bytes(src);
+    const __m128i first = _mm_set1_epi8(static_cast<char>(s[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(s[m - 1]));
+    for (std::size_t off = (end - 1) & ~std::size_t(15);; off -= 16) {
+        unsigned c =
+            str_eq_mask(str_load<N>(p, off), first) &
+            str_eq_mask(str_load<N>(p, off + m - 1), last) &
+            str_range(off, 0, end);
+        while (c) {
+            const std::size_t j = str_last(c);
+            if (std::memcmp(p + off + j, s, m) == 0)
+                return off + j;
+            c &= ~(1u << j);
+        }
+        if (off == 0)
+            return str_npos;
+    }
+}
+
+template<std::size_t N, std::size_t M, typename CharT>
+std::size_t str_mismatch(
+        const CharT* lhs, const CharT* rhs, std::size_t n,
+        std::true_type) noexcept
+{
+    const char* a = str_bytes(lhs);
+    const char* b = str_bytes(rhs);
+    for (std::size_t off = 0; off < n; off += 16) {
+        const unsigned d =
+            ~str_eq_mask(str_load<N>(a, off), str_load<M>(b, off)) &
+            str_range(off, 0, n);
+        if (d)
+            return off + str_first(d);
+    }
+    return n;
+}
+
+// Stops at the first position that differs or that ends lhs.
+template<std::size_t N, std::size_t M, typename CharT>
+int str_compare(const CharT* lhs, const CharT* rhs, std::true_type) noexcept
+{
+    constexpr std::size_t n = N < M ? N : M;
+    const char* a = str_bytes(lhs);
+    const char* b = str_bytes(rhs);
+    for (std::size_t off = 0; off < n; off += 16) {
+        const __m128i va = str_load<N>(a, off);
+        const unsigned stop =
+            (~str_eq_mask(va, str_load<M>(b, off)) | str_eq_mask(va, '\0')) &
+            str_range(off, 0, n);
+        if (stop) {
+            const std::size_t i = off + str_first(stop);
+            return int(str_uchar(a[i])) - int(str_uchar(b[i]));
+        }
+    }
+    if (N > M)
+        return a[n] != '\0';
+    if (N < M)
+        return -(b[n] != '\0');
+    return 0;
+}
+
+#endif // ASH_STRING_SIMD
+
+} // namespace details
+
+} // namespace ash
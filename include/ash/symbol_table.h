@@ -0,0 +1,217 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+
+#include "compare_base.h"
+#include "fixed_string.h"
+
+namespace ash {
+
+// A dense id handed out by a symbol_table. Symbols compare and hash as their
+// ids, so they order by first interning, not by name.
+class symbol : compareable<symbol>
+{
+public:
+    static const constexpr std::uint32_t invalid_id = ~std::uint32_t(0);
+
+public:
+    constexpr symbol() noexcept = default;
+
+    constexpr explicit symbol(std::uint32_t id) noexcept :
+        id_{id}
+    { }
+
+    constexpr std::uint32_t id() const noexcept     { return id_; }
+    constexpr bool valid() const noexcept           { return id_ != invalid_id; }
+    constexpr explicit operator bool() const noexcept { return valid(); }
+
+    constexpr bool operator==(const symbol& rhs) const noexcept
+    {
+        return id_ == rhs.id_;
+    }
+
+    constexpr bool operator<(const symbol& rhs) const noexcept
+    {
+        return id_ < rhs.id_;
+    }
+
+private:
+    std::uint32_t id_ = invalid_id;
+};
+
+inline std::ostream& operator<<(std::ostream& s, symbol sym)
+{
+    return s << '#' << sym.id();
+}
+
+// Maps strings of up to Capacity characters to symbols with ids 0, 1, 2...
+// in order of first interning. Lookups by name or id never lock, even while
+// another thread interns. Interning new names takes a mutex. The table holds
+// at most max_size() names, fixed at construction, so nothing ever moves.
+template<std::size_t Capacity, typename CharT = char>
+class symbol_table
+{
+public:
+    using string_type = fixed_string<Capacity, CharT>;
+    using size_type = std::size_t;
+
+public:
+    explicit symbol_table(size_type max_symbols) :
+        max_size_{checked_size(max_symbols)},
+        mask_{slot_count(max_symbols) - 1},
+        names_{new string_type[max_symbols]},
+        slots_{new std::atomic<std::uint64_t>[mask_ + 1]}
+    {
+        for (size_type i = 0; i <= mask_; ++i)
+            slots_[i].store(0, std::memory_order_relaxed);
+    }
+
+    symbol_table(const symbol_table&) = delete;
+    symbol_table& operator=(const symbol_table&) = delete;
+
+    // The symbol for name, or an invalid symbol if it was never interned.
+    symbol find(const string_type& name) const noexcept
+    {
+        const std::uint64_t h = hash_of(name);
+        for (size_type i = h & mask_;; i = (i + 1) & mask_) {
+            const std::uint64_t slot = slots_[i].load(std::memory_order_acquire);
+            if (slot == 0)
+                return symbol{};
+            if ((slot >> 32) == (h >> 32)) {
+                const std::uint32_t id = static_cast<std::uint32_t>(slot) - 1;
+                if (names_[id] == name)
+                    return symbol{id};
+            }
+        }
+    }
+
+    // The symbol for name, interning it if needed. Throws std::length_error
+    // if the table is full.
+    symbol intern(const string_type& name)
+    {
+        const symbol found = find(name);
+        if (found)
+            return found;
+
+        std::lock_guard<std::mutex> lock{mutex_};
+        const std::uint64_t h = hash_of(name);
+        size_type i = h & mask_;
+        for (;; i = (i + 1) & mask_) {
+            const std::uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+            if (slot == 0)
+                break;
+            if ((slot >> 32) == (h >> 32)) {
+                const std::uint32_t id = static_cast<std::uint32_t>(slot) - 1;
+                if (names_[id] == name)
+                    return symbol{id};
+            }
+        }
+
+        const size_type id = size_.load(std::memory_order_relaxed);
+        if (id == max_size_)
+            throw std::length_error("symbol_table: full");
+        names_[id] = name;
+        slots_[i].store(
+                (h & ~std::uint64_t(0xffffffff)) | (id + 1),
+                std::memory_order_release);
+        size_.store(id + 1, std::memory_order_release);
+        return symbol{static_cast<std::uint32_t>(id)};
+    }
+
+    // The name of a symbol from this table.
+    const string_type& name(symbol sym) const noexcept
+    {
+        assert(sym.id() < size());
+        return names_[sym.id()];
+    }
+
+    const string_type& operator[](symbol sym) const noexcept
+    {
+        return name(sym);
+    }
+
+    // Symbols with ids below size() have been interned.
+    size_type size() const noexcept
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    size_type max_size() const noexcept
+    {
+        return max_size_;
+    }
+
+private:
+    static size_type checked_size(size_type n)
+    {
+        if (n >= symbol::invalid_id)
+            throw std::length_error("symbol_table: too many symbols");
+        return n;
+    }
+
+    // At most half full, so probe runs stay short.
+    static size_type slot_count(size_type n) noexcept
+    {
+        size_type count = 16;
+        while (count < 2 * n)
+            count *= 2;
+        return count;
+    }
+
+    // The low bits pick the first slot, the high 32 are kept in the slot to
+    // skip most string compares.
+    static std::uint64_t hash_of(const string_type& name) noexcept
+    {
+        const std::size_t n = details::str_length<Capacity>(
+                name.data(), details::str_simd<CharT>{});
+        return details::str_hash<Capacity>(name.data(), n);
+    }
+
+private:
+    const size_type max_size_;
+    const size_type mask_;
+    std::unique_ptr<string_type[]> names_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots_;
+    std::atomic<size_type> size_{0};
+    std::mutex mutex_;
+};
+
+} // namespace ash
+
+namespace std {
+
+template<>
+struct hash<ash::symbol>
+{
+    std::size_t operator()(ash::symbol sym) const noexcept
+    {
+        return sym.id();
+    }
+};
+
+} // namespace std
@@ -17,15 +17,146 @@
 
 #pragma once
 
-#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
-#include <memory>
+#include <limits>
+#include <new>
+#include <stdexcept>
 #include <utility>
 
+#include "page_alloc.h"
+
+#ifndef ASH_SCRATCH_ARENA_SIZE
+#define ASH_SCRATCH_ARENA_SIZE (1024 * 1024)
+#endif
+
 namespace ash {
 
-template<class T>
+namespace details {
+
+// Per-thread stack of scratch memory. Blocks released out of order are
+// reclaimed once every block above them has been released.
+class scratch_arena
+{
+public:
+    static const constexpr std::size_t arena_size = ASH_SCRATCH_ARENA_SIZE;
+    static const constexpr std::size_t arena_align = 64;
+
+public:
+    scratch_arena() = default;
+    scratch_arena(const scratch_arena&) = delete;
+    scratch_arena& operator=(const scratch_arena&) = delete;
+
+    ~scratch_arena()
+    {
+        if (base_ != nullptr)
+            heap_alloc{}.deallocate(base_, arena_size, arena_align);
+    }
+
+    static
+    scratch_arena& local()
+    {
+        static thread_local scratch_arena arena;
+        return arena;
+    }
+
+    // Returns nullptr once the arena is exhausted.
+    void* allocate(std::size_t bytes, std::size_t align) noexcept
+    {
+        if (base_ == nullptr and not init())
+            return nullptr;
+        align = std::max(align, alignof(block_header));
+        const auto base = reinterpret_cast<std::uintptr_t>(base_);
+        const std::size_t start = details::round_up(
+                base + top_ + sizeof(block_header), align) - base;
+        if (start > arena_size or bytes > arena_size - start)
+            return nullptr;
+
+        const std::size_t hdr = start - sizeof(block_header);
+        new (base_ + hdr) block_header{top_, last_, false};
+        top_ = start + bytes;
+        last_ = hdr;
+        return base_ + start;
+    }
+
+    void deallocate(void* ptr) noexcept
+    {
+        header_of(ptr)->freed = true;
+        while (last_ != npos and header_at(last_)->freed) {
+            const block_header* hdr = header_at(last_);
+            top_ = hdr->prev_top;
+            last_ = hdr->prev_last;
+        }
+    }
+
+    bool owns(const void* ptr) const noexcept
+    {
+        const char* p = static_cast<const char*>(ptr);
+        return base_ != nullptr and p >= base_ and p < base_ + arena_size;
+    }
+
+    std::size_t used() const noexcept
+    {
+        return top_;
+    }
+
+private:
+    static const constexpr std::size_t npos =
+        std::numeric_limits<std::size_t>::max();
+
+    struct block_header
+    {
+        std::size_t prev_top;
+        std::size_t prev_last;
+        bool freed;
+    };
+
+    bool init() noexcept
+    {
+        try {
+            base_ = static_cast<char*>(
+                    heap_alloc{}.allocate(arena_size, arena_align));
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        return true;
+    }
+
+    block_header* header_at(std::size_t offset) const noexcept
+    {
+        return reinterpret_cast<block_header*>(base_ + offset);
+    }
+
+    block_header* header_of(void* ptr) const noexcept
+    {
+        return reinterpret_cast<block_header*>(
+                static_cast<char*>(ptr) - sizeof(block_header));
+    }
+
+private:
+    char* base_{nullptr};
+    std::size_t top_{0};
+    std::size_t last_{npos};
+};
+
+} // namespace details
+
+// Uninitialized scratch storage for n objects aligned to Align bytes. The
+// storage is padded to a multiple of Align, see padded_size(). Buffers are
+// carved out of a thread local arena and fall back to the heap once it is
+// exhausted; they must be released on the thread that created them, ideally
+// in LIFO order. With HugePages, buffers of at least a huge page are mapped
+// directly and backed by transparent huge pages.
+template<class T, std::size_t Align = alignof(T), bool HugePages = false>
 class unique_tmp_buffer {
+private:
+    static_assert(
+            Align >= alignof(T) and (Align & (Align - 1)) == 0,
+            "Align must be a power of two no smaller than alignof(T).");
+
+    enum class source : unsigned char { heap, arena, mapped };
+
 public:
     using reference = T&;
     using const_reference = const T&;
@@ -34,32 +165,34 @@ public:
     using const_iterator = const T*;
     using size_type = std::ptrdiff_t;
 
+    static const constexpr std::size_t alignment = Align;
+
 public:
-    unique_tmp_buffer(size_type n) :
-        data_{std::get_temporary_buffer<T>(n)}
-    { }
+    unique_tmp_buffer(size_type n)
+    {
+        acquire(n);
+    }
 
     unique_tmp_buffer(unique_tmp_buffer&& src) :
-        data_{src.data_}
+        data_{src.data_},
+        arena_{src.arena_},
+        source_{src.source_}
     {
         src.data_ = { nullptr, size_type{0} };
+        src.arena_ = nullptr;
     }
 
     ~unique_tmp_buffer()
     {
-        if (data_.first) {
-            std::return_temporary_buffer(data_.first);
-        }
+        release();
     }
 
     unique_tmp_buffer(const unique_tmp_buffer&) = delete;
 
     void reset(size_type n = 0)
     {
-        if (data_.first) {
-            std::return_temporary_buffer(data_.first);
-        }
-        data_ = std::get_temporary_buffer<T>(n);
+        release();
+        acquire(n);
     }
 
 public:
@@ -86,6 +219,13 @@ public:
     pointer get() const     { return data(); }
     size_type size() const  { return data_.second; }
 
+    // Number of objects that fit in the padded storage. Objects past size()
+    // are uninitialized but may be touched by whole-vector loops.
+    size_type padded_size() const
+    {
+        return static_cast<size_type>(storage_bytes(size()) / sizeof(T));
+    }
+
     iterator begin() const          { return data_.first; }
     iterator end() const            { return begin() + size(); }
     const_iterator cbegin() const   { return data_.first; }
@@ -97,7 +237,74 @@ public:
     }
 
 private:
-    std::pair<pointer, size_type> data_;
+    static constexpr
+    std::size_t storage_bytes(size_type n)
+    {
+        return details::round_up(n * sizeof(T), Align);
+    }
+
+    void acquire(size_type n) noexcept
+    {
+        data_ = { nullptr, size_type{0} };
+        const auto max_n =
+            (std::numeric_limits<size_type>::max() - Align) / sizeof(T);
+        if (n <= 0 or static_cast<std::size_t>(n) > max_n)
+            return;
+
+        const std::size_t bytes = storage_bytes(n);
+        void* mem = nullptr;
+        try {
+            mem = allocate(bytes);
+        } catch (const std::bad_alloc&) {
+            return;
+        }
+        data_ = { static_cast<pointer>(mem), n };
+    }
+
+    void* allocate(std::size_t bytes)
+    {
+        if (HugePages and bytes >= mmap_alloc::huge_page_size) {
+            source_ = source::mapped;
+            return mmap_alloc{}.allocate(bytes, alignof(T));
+        }
+        auto& arena = details::scratch_arena::local();
+        if (void* mem = arena.allocate(bytes, Align)) {
+            source_ = source::arena;
+            arena_ = &arena;
+            return mem;
+        }
+        source_ = source::heap;
+        return heap_alloc{}.allocate(bytes, Align);
+    }
+
+    void release() noexcept
+    {
+        if (data_.first != nullptr) {
+            const std::size_t bytes = storage_bytes(size());
+            switch (source_) {
+            case source::arena:
+                arena_->deallocate(data_.first);
+                break;
+            case source::mapped:
+                mmap_alloc{}.deallocate(data_.first, bytes, Align);
+                break;
+            case source::heap:
+                heap_alloc{}.deallocate(data_.first, bytes, Align);
+                break;
+            }
+        }
+        data_ = { nullptr, size_type{0} };
+        arena_ = nullptr;
+    }
+
+private:
+    std::pair<pointer, size_type> data_{nullptr, 0};
+    details::scratch_arena* arena_{nullptr};
+    source source_{source::heap};
 };
 
+// Cache line aligned scratch for SIMD kernels.
+template<class T>
+using simd_tmp_buffer = unique_tmp_buffer<T, 64, true>;
+
 } // namespace ash
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <Catch/catch.hpp>
+
+#include <ash/cached_hash.h>
+#include <ash/fixed_string.h>
+
+using symbol = ash::cached_hash<ash::fixed_string<16>>;
+
+TEST_CASE("cached hash", "[cached_hash]")
+{
+    const symbol ibm{ash::fixed_string<16>{"IBM"}};
+    CHECK(ibm.hash() == std::hash<ash::fixed_string<16>>{}(*ibm));
+    CHECK(std::hash<symbol>{}(ibm) == ibm.hash());
+    CHECK(ibm.get() == "IBM");
+    CHECK(ibm->size() == 3);
+
+    const symbol copy = ibm;
+    CHECK(copy == ibm);
+    CHECK(copy.hash() == ibm.hash());
+    CHECK(symbol{ash::fixed_string<16>{"AAPL"}} < ibm);
+    CHECK(symbol{ash::fixed_string<16>{"AAPL"}} != ibm);
+}
+
+TEST_CASE("cached hash as a key", "[cached_hash]")
+{
+    std::unordered_map<symbol, int> m;
+    m.emplace(ash::fixed_string<16>{"IBM"}, 1);
+    m.emplace(ash::fixed_string<16>{"MSFT"}, 2);
+    CHECK(m.at(ash::fixed_string<16>{"IBM"}) == 1);
+    CHECK(m.at(ash::fixed_string<16>{"MSFT"}) == 2);
+    CHECK(m.count(ash::fixed_string<16>{"AAPL"}) == 0);
+
+    std::unordered_set<ash::cached_hash<std::string>> s;
+    s.emplace("a");
+    s.emplace("b");
+    CHECK(s.count(std::string{"a"}) == 1);
+}
@@ -0,0 +1,359 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ash/charconv.h>
+#include <ash/fixed_string.h>
+
+namespace {
+
+using D3 = ash::fixed_decimal<3>;
+using D8 = ash::fixed_decimal<8>;
+
+template<class D>
+std::errc parse(const char* s, D& value, std::size_t expected_len = -1)
+{
+    const auto len = std::strlen(s);
+    const auto res = ash::from_chars(s, s + len, value);
+    if (expected_len == std::size_t(-1))
+        expected_len = (res.ec == std::errc::invalid_argument) ? 0 : len;
+    CHECK(static_cast<std::size_t>(res.ptr - s) == expected_len);
+    return res.ec;
+}
+
+template<class D>
+long long raw(const char* s)
+{
+    D value;
+    REQUIRE(parse(s, value) == std::errc{});
+    return value.raw_value();
+}
+
+template<class D>
+std::string format(D value, ash::trailing_zeros zeros = ash::trailing_zeros::keep)
+{
+    char buf[32];
+    const auto res = ash::to_chars(buf, buf + sizeof(buf), value, zeros);
+    REQUIRE(res.ec == std::errc{});
+    return std::string(buf, res.ptr);
+}
+
+template<typename T, typename... Options>
+std::string format_number(T value, Options... options)
+{
+    char buf[400];
+    const auto res = ash::to_chars(buf, buf + sizeof(buf), value, options...);
+    REQUIRE(res.ec == std::errc{});
+    return std::string(buf, res.ptr);
+}
+
+std::string printf_fixed(double value, int places)
+{
+    char buf[400];
+    const int n = std::snprintf(buf, sizeof(buf), "%.*f", places, value);
+    std::string s(buf, static_cast<std::size_t>(n));
+    if (s.find_first_not_of("-0.") == std::string::npos and s[0] == '-')
+        s.erase(0, 1);
+    return s;
+}
+
+} // namespace
+
+TEST_CASE("from_chars valid", "[charconv]")
+{
+    CHECK(raw<D3>("1.234") == 1234);
+    CHECK(raw<D3>("+1.234") == 1234);
+    CHECK(raw<D3>("-1.234") == -1234);
+    CHECK(raw<D3>("-0.5") == -500);
+    CHECK(raw<D3>("12") == 12000);
+    CHECK(raw<D3>("12.") == 12000);
+    CHECK(raw<D3>(".25") == 250);
+    CHECK(raw<D3>("000000000000000000000007") == 7000);
+    CHECK(raw<D8>("123456789.12345678") == 12345678912345678);
+    CHECK(raw<D8>("0.0000000000000000000000001") == 0);
+}
+
+TEST_CASE("from_chars exponents", "[charconv]")
+{
+    CHECK(raw<D3>("1.5e2") == 150000);
+    CHECK(raw<D3>("15E-1") == 1500);
+    CHECK(raw<D3>("1e+3") == 1000000);
+    CHECK(raw<D8>("25e-9") == 3);
+
+    D3 value;
+    CHECK(parse("1e", value, 1) == std::errc{});
+    CHECK(value == 1);
+    CHECK(parse("2e+x", value, 1) == std::errc{});
+    CHECK(value == 2);
+}
+
+TEST_CASE("from_chars rounding", "[charconv]")
+{
+    CHECK(raw<D3>("1.0005") == 1001);
+    CHECK(raw<D3>("1.00049999") == 1000);
+    CHECK(raw<D3>("-1.0005") == -1001);
+    CHECK(raw<D3>("0.0004") == 0);
+    CHECK(raw<D3>("2.71828182845904523536028747135") == 2718);
+    CHECK(raw<D3>("99999999999999.99999999999") == 100000000000000000);
+}
+
+TEST_CASE("from_chars errors", "[charconv]")
+{
+    D3 value{7};
+    CHECK(parse("", value) == std::errc::invalid_argument);
+    CHECK(parse("x", value) == std::errc::invalid_argument);
+    CHECK(parse("-", value) == std::errc::invalid_argument);
+    CHECK(parse(".", value) == std::errc::invalid_argument);
+    CHECK(parse("+.e5", value) == std::errc::invalid_argument);
+    CHECK(value == 7);
+
+    CHECK(parse("12x", value, 2) == std::errc{});
+    CHECK(value == 12);
+
+    CHECK(parse("9223372036854775.808", value) == std::errc::result_out_of_range);
+    CHECK(parse("1e30", value) == std::errc::result_out_of_range);
+    CHECK(parse("12345678901234567890123", value) ==
+            std::errc::result_out_of_range);
+    CHECK(value == 12);
+
+    CHECK(parse("-9223372036854775.808", value) == std::errc{});
+    CHECK(value.raw_value() == std::numeric_limits<long long>::min());
+
+    ash::ufixed_decimal<2> u;
+    CHECK(parse("-1", u) == std::errc::result_out_of_range);
+    CHECK(parse("18446744073709551.615", u) == std::errc{});
+    CHECK(u.raw_value() == 1844674407370955162ULL);
+}
+
+TEST_CASE("from_chars eight digit runs", "[charconv]")
+{
+    const std::string digits = "1234567890123456";
+    for (std::size_t len = 1; len <= digits.size(); ++len) {
+        const std::string s = digits.substr(0, len);
+        CHECK(raw<ash::fixed_decimal<0>>(s.c_str()) == std::stoll(s));
+        const std::string frac = "0." + s;
+        const long long rounded = std::stoll(s.substr(0, 8)) *
+            static_cast<long long>(std::pow(10, 8 - std::min<int>(len, 8))) +
+            (len > 8 and s[8] >= '5');
+        CHECK(raw<D8>(frac.c_str()) == rounded);
+    }
+}
+
+TEST_CASE("to_chars", "[charconv]")
+{
+    CHECK(format(D3::from_raw_value(1234)) == "1.234");
+    CHECK(format(D3::from_raw_value(-1234)) == "-1.234");
+    CHECK(format(D3::from_raw_value(12000)) == "12.000");
+    CHECK(format(D3::from_raw_value(0)) == "0.000");
+    CHECK(format(D3::from_raw_value(-5)) == "-0.005");
+    CHECK(format(D3::from_raw_value(-500)) == "-0.500");
+    CHECK(format(ash::fixed_decimal<0>::from_raw_value(-42)) == "-42");
+    CHECK(format(D8::from_raw_value(std::numeric_limits<long long>::min())) ==
+            "-92233720368.54775808");
+    CHECK(format(ash::ufixed_decimal<2>::from_raw_value(
+                    std::numeric_limits<unsigned long long>::max())) ==
+            "184467440737095516.15");
+}
+
+TEST_CASE("to_chars trailing zeros", "[charconv]")
+{
+    const auto trim = ash::trailing_zeros::trim;
+    CHECK(format(D3::from_raw_value(1200), trim) == "1.2");
+    CHECK(format(D3::from_raw_value(12000), trim) == "12");
+    CHECK(format(D3::from_raw_value(0), trim) == "0");
+    CHECK(format(D3::from_raw_value(-50), trim) == "-0.05");
+    CHECK(format(D3::from_raw_value(1001), trim) == "1.001");
+}
+
+TEST_CASE("to_chars buffer too small", "[charconv]")
+{
+    char buf[8];
+    std::memset(buf, 'x', sizeof(buf));
+    auto res = ash::to_chars(buf, buf + 5, D3::from_raw_value(-1234), {});
+    CHECK(res.ec == std::errc::value_too_large);
+    CHECK(res.ptr == buf + 5);
+    CHECK(buf[0] == 'x');
+
+    res = ash::to_chars(buf, buf + 6, D3::from_raw_value(-1234));
+    CHECK(res.ec == std::errc{});
+    CHECK(std::string(buf, res.ptr) == "-1.234");
+}
+
+TEST_CASE("to_chars fixed_string", "[charconv]")
+{
+    ash::fixed_string<8> s{"old"};
+    CHECK(ash::to_chars(s, D3::from_raw_value(-1200)) == std::errc{});
+    CHECK(s == "-1.200");
+    CHECK(ash::to_chars(s, D3::from_raw_value(-1200),
+                ash::trailing_zeros::trim) == std::errc{});
+    CHECK(s == "-1.2");
+    CHECK(ash::to_chars(s, D8::from_raw_value(1)) ==
+            std::errc::value_too_large);
+    CHECK(s == "-1.2");
+
+    ash::fixed_string<6> full;
+    CHECK(ash::to_chars(full, D3::from_raw_value(-1234)) == std::errc{});
+    CHECK(full.length() == 6);
+    CHECK(full.str() == "-1.234");
+}
+
+TEST_CASE("to_chars integers", "[charconv]")
+{
+    CHECK(format_number(0) == "0");
+    CHECK(format_number(-7) == "-7");
+    CHECK(format_number(short(-32768)) == "-32768");
+    CHECK(format_number(1234567890u) == "1234567890");
+    CHECK(format_number(std::numeric_limits<long long>::min()) ==
+            "-9223372036854775808");
+    CHECK(format_number(std::numeric_limits<unsigned long long>::max()) ==
+            "18446744073709551615");
+
+    std::mt19937_64 gen{3};
+    for (int i = 0; i != 10000; ++i) {
+        const auto v = static_cast<long long>(gen()) >> (gen() % 64);
+        CHECK(format_number(v) == std::to_string(v));
+    }
+
+    char buf[4];
+    std::memset(buf, 'x', sizeof(buf));
+    const auto res = ash::to_chars(buf, buf + 4, -1234);
+    CHECK(res.ec == std::errc::value_too_large);
+    CHECK(buf[0] == 'x');
+}
+
+TEST_CASE("to_chars doubles", "[charconv]")
+{
+    const auto trim = ash::trailing_zeros::trim;
+    CHECK(format_number(1.5) == "1.500000");
+    CHECK(format_number(-1.5, 2u) == "-1.50");
+    CHECK(format_number(0.125, 2u) == "0.12");
+    CHECK(format_number(0.375, 2u) == "0.38");
+    CHECK(format_number(2.5, 0u) == "2");
+    CHECK(format_number(-0.0, 3u) == "0.000");
+    CHECK(format_number(-0.0001, 2u) == "0.00");
+    CHECK(format_number(101.25, 4u, trim) == "101.25");
+    CHECK(format_number(100.0, 4u, trim) == "100");
+    CHECK(format_number(1e20, 2u) == "100000000000000000000.00");
+    CHECK(format_number(1e20, 2u, trim) == "100000000000000000000");
+    CHECK(format_number(-1e300, 0u) == printf_fixed(-1e300, 0));
+    CHECK(format_number(std::numeric_limits<double>::max(), 17u).size() ==
+            309 + 18);
+
+    char buf[32];
+    CHECK(ash::to_chars(buf, buf + sizeof(buf), std::nan(""), 2).ec ==
+            std::errc::invalid_argument);
+    CHECK(ash::to_chars(buf, buf + sizeof(buf), HUGE_VAL, 2).ec ==
+            std::errc::invalid_argument);
+    CHECK(ash::to_chars(buf, buf + sizeof(buf), 1.0, 18).ec ==
+            std::errc::invalid_argument);
+    CHECK(ash::to_chars(buf, buf + 3, 1.25, 2).ec ==
+            std::errc::value_too_large);
+    CHECK(ash::to_chars(buf, buf + 4, 1e20, 0).ec ==
+            std::errc::value_too_large);
+
+    std::mt19937_64 gen{5};
+    std::uniform_real_distribution<double> unit{-1, 1};
+    for (int i = 0; i != 20000; ++i) {
+        const double v = unit(gen) * std::pow(10.0, int(gen() % 40) - 10);
+        const unsigned places = static_cast<unsigned>(gen() % 18);
+        CHECK(format_number(v, places) == printf_fixed(v, int(places)));
+    }
+}
+
+TEST_CASE("to_chars round trip", "[charconv]")
+{
+    std::mt19937_64 gen{7};
+    for (int i = 0; i != 10000; ++i) {
+        const auto value = D8::from_raw_value(static_cast<long long>(gen()));
+        const std::string text = format(value);
+        D8 parsed;
+        REQUIRE(parse(text.c_str(), parsed) == std::errc{});
+        CHECK(parsed.raw_value() == value.raw_value());
+
+        std::ostringstream ss;
+        ss << value;
+        CHECK(ss.str() == text);
+    }
+}
+
+TEST_CASE("to_chars benchmark", "[.][benchmark][charconv]")
+{
+    std::mt19937_64 gen{11};
+    std::uniform_int_distribution<long long> dist{-1'000'000'000'000, 1'000'000'000'000};
+    std::vector<D8> values(100'000);
+    for (auto& v : values)
+        v = D8::from_raw_value(dist(gen));
+
+    const auto time_ms = [](auto&& f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    };
+
+    std::size_t sink = 0;
+    const double stream = time_ms([&] {
+        std::ostringstream ss;
+        for (auto v : values) {
+            ss.seekp(0);
+            ss << v;
+            sink += static_cast<std::size_t>(ss.tellp());
+        }
+    });
+    const double chars = time_ms([&] {
+        char buf[32];
+        for (auto v : values)
+            sink += ash::to_chars(buf, buf + sizeof(buf), v).ptr - buf;
+    });
+
+    const double to_string = time_ms([&] {
+        ash::fixed_string<64> s;
+        for (auto v : values) {
+            s = "44=";
+            s.append(std::to_string(v.as_double()).c_str());
+            sink += s.length();
+        }
+    });
+    const double append = time_ms([&] {
+        ash::fixed_string<64> s;
+        for (auto v : values) {
+            s = "44=";
+            s.append(v.as_double());
+            sink += s.length();
+        }
+    });
+
+    std::cout
+        << "100k fixed_decimal<8> (ms, ostream / to_chars)\n"
+        << "  format " << stream << " / " << chars << '\n'
+        << "100k doubles into fixed_string (ms, std::to_string / append)\n"
+        << "  append " << to_string << " / " << append << '\n';
+    CHECK(sink != 0);
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <ash/decimal_codec.h>
+
+namespace {
+
+using D8 = ash::fixed_decimal<8>;
+using encoder = ash::decimal_encoder<8>;
+using decoder = ash::decimal_decoder<8>;
+const std::size_t block_size = ash::decimal_codec::block_size;
+
+std::vector<D8> random_walk(std::size_t n, long long step, unsigned seed)
+{
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<long long> dist{-step, step};
+    std::vector<D8> xs;
+    long long px = 10'000'000'000;
+    for (std::size_t i = 0; i != n; ++i) {
+        px += dist(gen);
+        xs.push_back(D8::from_raw_value(px));
+    }
+    return xs;
+}
+
+std::vector<std::uint8_t> encode(const std::vector<D8>& xs)
+{
+    std::vector<std::uint8_t> bytes;
+    encoder enc{bytes};
+    enc.append(ash::make_span(xs));
+    enc.flush();
+    CHECK(enc.size() == xs.size());
+    return bytes;
+}
+
+std::vector<D8> decode(const std::vector<std::uint8_t>& bytes)
+{
+    decoder dec{ash::make_span(bytes)};
+    std::vector<D8> xs;
+    D8 block[block_size];
+    for (auto n = dec.next(ash::make_span(block, block_size)); n != 0;
+            n = dec.next(ash::make_span(block, block_size)))
+        xs.insert(xs.end(), block, block + n);
+    return xs;
+}
+
+} // namespace
+
+TEST_CASE("decimal codec round trip", "[decimal_codec]")
+{
+    SECTION("random walk") {
+        const auto xs = random_walk(10'000, 500, 1);
+        const auto bytes = encode(xs);
+        CHECK(decode(bytes) == xs);
+        // Deltas fit in 11 bits, a factor of at least five over raw values.
+        CHECK(bytes.size() * 5 < xs.size() * sizeof(D8));
+    }
+    SECTION("constant") {
+        const std::vector<D8> xs(1000, D8{42});
+        const auto bytes = encode(xs);
+        CHECK(decode(bytes) == xs);
+        CHECK(bytes.size() < 100);
+    }
+    SECTION("extremes") {
+        std::mt19937_64 gen{2};
+        std::vector<D8> xs;
+        for (int i = 0; i != 1000; ++i) {
+            const auto r = gen();
+            xs.push_back(D8::from_raw_value(
+                        (r % 3 == 0) ? std::numeric_limits<long long>::min() :
+                        (r % 3 == 1) ? std::numeric_limits<long long>::max() :
+                        static_cast<long long>(gen())));
+        }
+        CHECK(decode(encode(xs)) == xs);
+    }
+    SECTION("every width") {
+        std::mt19937_64 gen{3};
+        for (unsigned width = 1; width <= 64; ++width) {
+            INFO("width " << width);
+            std::vector<D8> xs;
+            long long v = 0;
+            for (int i = 0; i != 300; ++i) {
+                const auto delta = gen() >> (64 - width);
+                v = static_cast<long long>(static_cast<std::uint64_t>(v) + delta);
+                xs.push_back(D8::from_raw_value(v));
+            }
+            REQUIRE(decode(encode(xs)) == xs);
+        }
+    }
+    SECTION("unsigned") {
+        using U2 = ash::ufixed_decimal<2>;
+        std::vector<std::uint8_t> bytes;
+        ash::decimal_encoder<2, unsigned long long> enc{bytes};
+        enc.append(U2::from_raw_value(std::numeric_limits<unsigned long long>::max()));
+        enc.append(U2::from_raw_value(0));
+        enc.append(U2::from_raw_value(5));
+        enc.flush();
+        ash::decimal_decoder<2, unsigned long long> dec{ash::make_span(bytes)};
+        CHECK(dec.size() == 3);
+        CHECK(dec.at(0).raw_value() == std::numeric_limits<unsigned long long>::max());
+        CHECK(dec.at(2).raw_value() == 5);
+    }
+    SECTION("empty") {
+        const std::vector<std::uint8_t> bytes;
+        decoder dec{ash::make_span(bytes)};
+        D8 block[block_size];
+        CHECK(dec.next(ash::make_span(block, block_size)) == 0);
+        CHECK(dec.size() == 0);
+    }
+}
+
+TEST_CASE("decimal codec random access", "[decimal_codec]")
+{
+    const auto xs = random_walk(1000, 10'000, 4);
+    std::vector<std::uint8_t> bytes;
+    encoder enc{bytes};
+    // A flush mid-stream leaves a short block.
+    enc.append(ash::make_span(xs.data(), 200));
+    enc.flush();
+    enc.append(ash::make_span(xs.data() + 200, 800));
+    enc.flush();
+    CHECK(enc.block_count() == 2 + 7);
+
+    decoder dec{ash::make_span(bytes)};
+    CHECK(dec.size() == xs.size());
+    CHECK(dec.block_count() == enc.block_count());
+    for (std::size_t i = 0; i < xs.size(); i += 37)
+        CHECK(dec.at(i) == xs[i]);
+    CHECK(dec.at(999) == xs[999]);
+    CHECK_THROWS_AS(dec.at(1000), std::out_of_range);
+
+    D8 block[block_size];
+    CHECK(dec.decode_block(1, ash::make_span(block, block_size)) == 72);
+    CHECK(block[0] == xs[128]);
+
+    dec.seek(2);
+    CHECK(dec.next(ash::make_span(block, block_size)) == block_size);
+    CHECK(block[0] == xs[200]);
+    dec.seek(dec.block_count());
+    CHECK(dec.next(ash::make_span(block, block_size)) == 0);
+}
+
+TEST_CASE("decimal codec corrupt input", "[decimal_codec]")
+{
+    auto bytes = encode(random_walk(300, 100, 5));
+    D8 block[block_size];
+
+    auto truncated = bytes;
+    truncated.resize(truncated.size() - 1);
+    CHECK_THROWS_AS(decoder{ash::make_span(truncated)}.size(), std::runtime_error);
+
+    auto bad_count = bytes;
+    bad_count[0] = 200;
+    decoder dec{ash::make_span(bad_count)};
+    CHECK_THROWS_AS(dec.next(ash::make_span(block, block_size)), std::runtime_error);
+
+    std::vector<std::uint8_t> bad_varint = {1, 0, 0xFF, 0xFF};
+    decoder dec2{ash::make_span(bad_varint)};
+    CHECK_THROWS_AS(dec2.next(ash::make_span(block, block_size)), std::runtime_error);
+}
+
+TEST_CASE("decimal codec benchmark", "[.][benchmark][decimal_codec]")
+{
+    const auto xs = random_walk(10'000'000, 2'000, 6);
+    const auto time_ms = [](auto&& f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    };
+
+    std::vector<std::uint8_t> bytes;
+    const double enc_ms = time_ms([&] { bytes = encode(xs); });
+    std::vector<D8> out(xs.size() + block_size);
+    const double dec_ms = time_ms([&] {
+        decoder dec{ash::make_span(bytes)};
+        std::size_t n = 0;
+        while (std::size_t k = dec.next(ash::make_span(out).subspan(n)))
+            n += k;
+    });
+    out.resize(xs.size());
+    CHECK(out == xs);
+
+    std::cout
+        << "10M fixed_decimal<8> random walk\n"
+        << "  ratio  " << double(xs.size() * sizeof(D8)) / bytes.size() << "x\n"
+        << "  encode " << enc_ms << " ms\n"
+        << "  decode " << dec_ms << " ms\n";
+}
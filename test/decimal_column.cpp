@@ -0,0 +1,225 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <ash/decimal_column.h>
+
+namespace {
+
+using D2 = ash::fixed_decimal<2>;
+using D8 = ash::fixed_decimal<8>;
+using column = ash::decimal_column<8>;
+using view = ash::decimal_column_view<8>;
+using wide = column::wide_type;
+
+// Large enough to be split over several threads.
+const std::size_t large = 5 * ash::details::block_runner::min_block + 17;
+
+column random_column(std::size_t n, long long lo, long long hi, unsigned seed)
+{
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<long long> dist{lo, hi};
+    column c;
+    for (std::size_t i = 0; i != n; ++i)
+        c.append_raw(dist(gen));
+    return c;
+}
+
+wide naive_sum(view xs, std::size_t first, std::size_t last)
+{
+    wide s = 0;
+    for (std::size_t i = first; i != last; ++i)
+        s += xs[i].raw_value();
+    return s;
+}
+
+} // namespace
+
+TEST_CASE("decimal_column append and slice", "[decimal_column]")
+{
+    column c;
+    CHECK(c.empty());
+    for (int i = 0; i != 1000; ++i)
+        c.append(D8{i});
+    CHECK(c.size() == 1000);
+    CHECK(c.capacity() >= 1000);
+    CHECK(reinterpret_cast<std::uintptr_t>(c.data()) % column::alignment == 0);
+    CHECK(c[999] == D8{999});
+
+    const D8 more[] = {D8{1.5}, D8{2.5}};
+    c.append(ash::make_span(more, 2));
+    CHECK(c.size() == 1002);
+    CHECK(c[1001] == D8{2.5});
+
+    const view s = c.slice(10, 5);
+    CHECK(s.size() == 5);
+    CHECK(s[0] == D8{10});
+    CHECK(s.raw()[4] == D8{14}.raw_value());
+    CHECK(c.slice(1000).size() == 2);
+    CHECK(s.slice(1, 100).size() == 4);
+
+    column copy{c};
+    CHECK(copy.size() == c.size());
+    CHECK(copy[500] == c[500]);
+    column moved{std::move(copy)};
+    CHECK(moved.size() == 1002);
+    CHECK(copy.empty());
+
+    c.clear();
+    CHECK(c.empty());
+}
+
+TEST_CASE("decimal_column append itself", "[decimal_column]")
+{
+    column c;
+    for (int i = 0; i != 10; ++i)
+        c.append(D8{i});
+    while (c.size() != c.capacity())
+        c.append(D8{-1});
+
+    // Growing frees the block the span views.
+    const std::size_t n = c.size();
+    c.append(c.values());
+    REQUIRE(c.size() == 2 * n);
+    CHECK(c[n] == D8{0});
+    CHECK(c[n + 9] == D8{9});
+
+    c.append(c.slice(5, 3).values());
+    CHECK(c[2 * n] == D8{5});
+    CHECK(c[2 * n + 2] == D8{7});
+}
+
+TEST_CASE("decimal_column sum", "[decimal_column]")
+{
+    const auto c = random_column(large, -1'000'000'000'000, 1'000'000'000'000, 1);
+    const wide expected = naive_sum(c, 0, c.size());
+    CHECK(c.sum_raw(1) == expected);
+    CHECK(c.sum_raw(4) == expected);
+    CHECK(c.slice(100, 1000).sum_raw() == naive_sum(c, 100, 1100));
+    CHECK(c.sum(4).raw_value() == static_cast<long long>(expected));
+
+    SECTION("exceeds 64 bits") {
+        column big;
+        const auto max = std::numeric_limits<long long>::max();
+        for (int i = 0; i != 10; ++i)
+            big.append_raw(max);
+        big.append_raw(std::numeric_limits<long long>::min());
+        CHECK(big.sum_raw() == wide(max) * 10 + std::numeric_limits<long long>::min());
+        CHECK_THROWS_AS(big.sum(), std::overflow_error);
+        CHECK(big.sum<ash::overflow::saturate>().raw_value() == max);
+    }
+    SECTION("unsigned") {
+        ash::decimal_column<2, unsigned long long> u;
+        const auto max = std::numeric_limits<unsigned long long>::max();
+        u.append_raw(max);
+        u.append_raw(max);
+        CHECK(u.sum_raw() == ash::decimal_column<2, unsigned long long>::wide_type(max) * 2);
+    }
+}
+
+TEST_CASE("decimal_column min and max", "[decimal_column]")
+{
+    auto c = random_column(large, -1'000'000, 1'000'000, 2);
+    c.append(D8{-50});
+    c.append(D8{50});
+    CHECK(c.min(4) == D8{-50});
+    CHECK(c.max(4) == D8{50});
+    CHECK(c.slice(0, 3).min(1) == std::min({c[0], c[1], c[2]}));
+}
+
+TEST_CASE("decimal_column vwap", "[decimal_column]")
+{
+    const auto px = random_column(large, 10'000'000'000, 20'000'000'000, 3);
+    ash::decimal_column<0> qty;
+    std::mt19937_64 gen{4};
+    for (std::size_t i = 0; i != px.size(); ++i)
+        qty.append_raw(static_cast<long long>(gen() % 1'000'000));
+
+    wide notional = 0, volume = 0;
+    for (std::size_t i = 0; i != px.size(); ++i) {
+        notional += wide(px[i].raw_value()) * qty[i].raw_value();
+        volume += qty[i].raw_value();
+    }
+    CHECK(px.vwap(qty, 4).raw_value() == static_cast<long long>(notional / volume));
+    CHECK(px.vwap(qty, 4) >= px.min());
+    CHECK(px.vwap(qty, 4) <= px.max());
+
+    column p;
+    ash::decimal_column<0> q;
+    p.append(D8{10});
+    p.append(D8{11});
+    q.append_raw(2);
+    q.append_raw(1);
+    CHECK(p.vwap(q).raw_value() == 1'033'333'333);
+    CHECK(p.vwap<ash::rounding::half_up>(q).raw_value() == 1'033'333'333);
+    CHECK(p.vwap<ash::rounding::ceil>(q).raw_value() == 1'033'333'334);
+    CHECK(p.slice(0, 0).vwap(q.slice(0, 0)) == D8{0});
+}
+
+TEST_CASE("decimal_column prefix sum", "[decimal_column]")
+{
+    const auto c = random_column(large, -1'000'000'000, 1'000'000'000, 5);
+    std::vector<D8> out(c.size());
+    c.prefix_sum(ash::make_span(out), 4);
+    wide s = 0;
+    for (std::size_t i = 0; i != c.size(); ++i) {
+        s += c[i].raw_value();
+        REQUIRE(out[i].raw_value() == static_cast<long long>(s));
+    }
+
+    column big;
+    big.append_raw(std::numeric_limits<long long>::max());
+    big.append_raw(1);
+    CHECK_THROWS_AS(big.prefix_sum(ash::make_span(out)), std::overflow_error);
+}
+
+TEST_CASE("decimal_column rolling windows", "[decimal_column]")
+{
+    const auto c = random_column(large, -1'000'000'000, 1'000'000'000, 6);
+    const std::size_t window = 100;
+    std::vector<D8> sums(c.size()), means(c.size());
+    const auto n = c.rolling_sum(window, ash::make_span(sums), 4);
+    CHECK(n == c.size() - window + 1);
+    CHECK(c.rolling_mean(window, ash::make_span(means), 4) == n);
+    for (std::size_t i = 0; i < n; i += 997) {
+        const wide s = naive_sum(c, i, i + window);
+        CHECK(sums[i].raw_value() == static_cast<long long>(s));
+        CHECK(means[i].raw_value() == static_cast<long long>(s / wide(window)));
+    }
+    CHECK(sums[n - 1].raw_value() ==
+            static_cast<long long>(naive_sum(c, n - 1, c.size())));
+
+    column small;
+    small.append(D8{1});
+    small.append(D8{2});
+    CHECK(small.rolling_sum(3, ash::make_span(sums)) == 0);
+    CHECK(small.rolling_mean<ash::rounding::half_up>(2, ash::make_span(means)) == 1);
+    CHECK(means[0] == D8{1.5});
+
+    ash::decimal_column<2> cents;
+    cents.append(D2{0.01});
+    cents.append(D2{0.02});
+    std::vector<D2> avg(1);
+    cents.rolling_mean<ash::rounding::half_even>(2, ash::make_span(avg));
+    CHECK(avg[0].raw_value() == 2);
+}
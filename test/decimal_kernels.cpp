@@ -0,0 +1,356 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <ash/decimal_kernels.h>
+
+namespace {
+
+using D2 = ash::fixed_decimal<2>;
+using D4 = ash::fixed_decimal<4>;
+using D8 = ash::fixed_decimal<8>;
+
+std::vector<D8> random_prices(std::size_t n)
+{
+    std::mt19937_64 gen{42};
+    std::uniform_int_distribution<long long> dist{-50'000'000'000, 50'000'000'000};
+    std::vector<D8> prices;
+    prices.reserve(n);
+    for (std::size_t i = 0; i != n; ++i)
+        prices.push_back(D8::from_raw_value(dist(gen)));
+    return prices;
+}
+
+template<typename Func>
+double time_ms(Func&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+} // namespace
+
+TEST_CASE("decimal sum", "[decimal_kernels]")
+{
+    const auto prices = random_prices(1003);
+    long long expected = 0;
+    for (auto p : prices)
+        expected += p.raw_value();
+    CHECK(ash::decimal::sum(ash::make_span(prices)).raw_value() == expected);
+
+    std::vector<D8> empty;
+    CHECK(ash::decimal::sum(ash::make_span(empty)) == 0);
+}
+
+TEST_CASE("decimal scale and mul", "[decimal_kernels]")
+{
+    const auto prices = random_prices(37);
+    std::vector<D8> out(prices.size());
+
+    ash::decimal::scale(ash::make_span(prices), -3, ash::make_span(out));
+    for (std::size_t i = 0; i != prices.size(); ++i)
+        CHECK(out[i] == prices[i] * -3);
+
+    std::vector<D4> a, b;
+    for (int i = 0; i != 21; ++i) {
+        a.push_back(D4::from_raw_value(i * 12345 - 70000));
+        b.push_back(D4::from_raw_value(i * 777 + 3));
+    }
+    std::vector<D4> prod(a.size());
+    ash::decimal::mul(ash::make_span(a), ash::make_span(b), ash::make_span(prod));
+    for (std::size_t i = 0; i != a.size(); ++i)
+        CHECK(prod[i] == a[i] * b[i]);
+}
+
+TEST_CASE("decimal mul at fixed_decimal<8> magnitudes", "[decimal_kernels]")
+{
+    // Raw products of prices and quantities far exceed 64 bits.
+    std::vector<D8> px{D8{100}, D8{-100}, D8{1.5}, D8::from_raw_value(1)};
+    std::vector<D8> qty{D8{100}, D8{25}, D8{-1.5}, D8::from_raw_value(99'999'999)};
+    std::vector<D8> prod(px.size());
+    ash::decimal::mul(ash::make_span(px), ash::make_span(qty), ash::make_span(prod));
+    CHECK(prod[0] == D8{10000});
+    CHECK(prod[1] == D8{-2500});
+    CHECK(prod[2] == D8{-2.25});
+    CHECK(prod[3].raw_value() == 0);
+
+    std::mt19937_64 gen{9};
+    std::uniform_int_distribution<long long> price{-50'000'000'000, 50'000'000'000};
+    std::uniform_int_distribution<long long> size{1, 100'000'000'000};
+    std::vector<D8> a, b;
+    for (int i = 0; i != 1001; ++i) {
+        a.push_back(D8::from_raw_value(price(gen)));
+        b.push_back(D8::from_raw_value(size(gen)));
+    }
+    prod.resize(a.size());
+    ash::decimal::mul(ash::make_span(a), ash::make_span(b), ash::make_span(prod));
+    for (std::size_t i = 0; i != a.size(); ++i) {
+        CHECK(prod[i] == a[i] * b[i]);
+        const double expected = a[i].as_double() * b[i].as_double();
+        CHECK(std::fabs(prod[i].as_double() - expected) <=
+                1e-8 + std::fabs(expected) * 1e-12);
+    }
+}
+
+TEST_CASE("decimal mul matches multiply", "[decimal_kernels]")
+{
+    using ash::overflow::checked;
+    using ash::overflow::saturate;
+    using ash::rounding::half_even;
+
+    const auto a = random_prices(257);
+    const std::vector<D8> b(a.rbegin(), a.rend());
+    const auto xs = ash::make_span(a);
+    const auto ys = ash::make_span(b);
+    std::vector<D8> prod(a.size());
+    const auto out = ash::make_span(prod);
+
+    ash::decimal::mul<saturate, half_even>(xs, ys, out);
+    for (std::size_t i = 0; i != a.size(); ++i)
+        CHECK(prod[i] == (ash::multiply<saturate, half_even>(a[i], b[i])));
+
+    std::vector<D8> big{D8{1e10}, D8{1}};
+    std::vector<D8> big_out(big.size());
+    CHECK_THROWS_AS(ash::decimal::mul<checked>(
+                ash::make_span(big), ash::make_span(big), ash::make_span(big_out)),
+            std::overflow_error);
+    ash::decimal::mul<saturate>(
+            ash::make_span(big), ash::make_span(big), ash::make_span(big_out));
+    CHECK(big_out[0].raw_value() == std::numeric_limits<long long>::max());
+    CHECK(big_out[1] == D8{1});
+}
+
+TEST_CASE("decimal rescale", "[decimal_kernels]")
+{
+    std::vector<D4> prices{D4{1.5}, D4{-2.25}, D4::from_raw_value(12345), D4{3}, D4{7}};
+    SECTION("up") {
+        std::vector<D8> out(prices.size());
+        ash::decimal::rescale<8>(ash::make_span(prices), ash::make_span(out));
+        for (std::size_t i = 0; i != prices.size(); ++i)
+            CHECK(out[i] == D8{prices[i]});
+    }
+    SECTION("down") {
+        std::vector<D2> out(prices.size());
+        ash::decimal::rescale<2>(ash::make_span(prices), ash::make_span(out));
+        for (std::size_t i = 0; i != prices.size(); ++i)
+            CHECK(out[i].raw_value() == D2{prices[i]}.raw_value());
+    }
+}
+
+TEST_CASE("decimal to_double", "[decimal_kernels]")
+{
+    auto prices = random_prices(102);
+    prices[5] = D8::from_raw_value(1LL << 60);
+    std::vector<double> out(prices.size());
+    ash::decimal::to_double(ash::make_span(prices), ash::make_span(out));
+    for (std::size_t i = 0; i != prices.size(); ++i)
+        CHECK(out[i] == Approx(prices[i].as_double()).epsilon(0));
+}
+
+template<class Rounding>
+void check_from_double(const std::vector<double>& xs)
+{
+    std::vector<D8> batch(xs.size());
+    REQUIRE(ash::decimal::from_double<Rounding>(
+                ash::make_span(xs), ash::make_span(batch)) == xs.size());
+    for (std::size_t i = 0; i != xs.size(); ++i) {
+        D8 x;
+        REQUIRE(ash::from_double<Rounding>(xs[i], x) == std::errc{});
+        INFO(xs[i]);
+        CHECK(batch[i] == x);
+    }
+}
+
+TEST_CASE("decimal from_double", "[decimal_kernels]")
+{
+    std::mt19937_64 gen{17};
+    std::uniform_real_distribution<double> dist{-1e5, 1e5};
+    std::vector<double> xs = {0.0, -0.0, 0.29, -0.29, 5e-324, -5e-324, 1e10, -1e10};
+    for (int i = 0; i != 10'000; ++i) {
+        const double v = dist(gen);
+        switch (i % 4) {
+        case 0: xs.push_back(v); break;
+        case 1: xs.push_back(std::round(v * 100) / 100); break;
+        // Halves of the last decimal place are exact ties.
+        case 2: xs.push_back(std::ldexp(std::round(std::ldexp(v, 10)), -10) * 1e-6); break;
+        // Past 2^52 units, handled by the scalar path.
+        case 3: xs.push_back(v * 1e5); break;
+        }
+    }
+    check_from_double<ash::rounding::half_even>(xs);
+    check_from_double<ash::rounding::half_up>(xs);
+    check_from_double<ash::rounding::truncate>(xs);
+    check_from_double<ash::rounding::floor>(xs);
+    check_from_double<ash::rounding::ceil>(xs);
+
+    SECTION("errors") {
+        std::vector<D8> out(xs.size());
+        xs[4321] = std::nan("");
+        CHECK(ash::decimal::from_double(ash::make_span(xs), ash::make_span(out)) == 4321);
+        xs[4321] = 1.0;
+        xs[9000] = -1e12;
+        CHECK(ash::decimal::from_double(ash::make_span(xs), ash::make_span(out)) == 9000);
+    }
+}
+
+TEST_CASE("decimal min max", "[decimal_kernels]")
+{
+    const auto prices = random_prices(999);
+    const auto span = ash::make_span(prices);
+    const auto mm = std::minmax_element(prices.begin(), prices.end());
+    CHECK(ash::decimal::min(span) == *mm.first);
+    CHECK(ash::decimal::max(span) == *mm.second);
+
+    std::vector<D8> one{D8{-1}};
+    CHECK(ash::decimal::min(ash::make_span(one)) == D8{-1});
+}
+
+TEST_CASE("decimal kernels benchmark", "[.][benchmark][decimal_kernels]")
+{
+    const auto prices = random_prices(100'000);
+    const auto span = ash::make_span(prices);
+    std::vector<D8> out(prices.size());
+    std::vector<double> dbl(prices.size());
+    constexpr int reps = 100;
+
+    long long sink = 0;
+    const double scalar_sum = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            D8 total;
+            for (auto p : prices)
+                total = D8::from_raw_value(total.raw_value() + p.raw_value());
+            sink += total.raw_value();
+        }
+    });
+    const double batch_sum = time_ms([&] {
+        for (int r = 0; r != reps; ++r)
+            sink += ash::decimal::sum(span).raw_value();
+    });
+
+    const double scalar_scale = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            for (std::size_t i = 0; i != prices.size(); ++i)
+                out[i] = prices[i] * 3;
+            sink += out[r].raw_value();
+        }
+    });
+    const double batch_scale = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            ash::decimal::scale(span, 3, ash::make_span(out));
+            sink += out[r].raw_value();
+        }
+    });
+
+    const std::vector<D8> qty = [&] {
+        std::vector<D8> q(prices.size());
+        for (std::size_t i = 0; i != q.size(); ++i)
+            q[i] = D8::from_raw_value(static_cast<long long>(i % 1000 + 1) * 100'000'000);
+        return q;
+    }();
+    const double scalar_mul = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            for (std::size_t i = 0; i != prices.size(); ++i)
+                out[i] = prices[i] * qty[i];
+            sink += out[r].raw_value();
+        }
+    });
+    const double batch_mul = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            ash::decimal::mul(span, ash::make_span(qty), ash::make_span(out));
+            sink += out[r].raw_value();
+        }
+    });
+
+    std::vector<D4> coarse(prices.size());
+    const double scalar_rescale = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            for (std::size_t i = 0; i != prices.size(); ++i)
+                coarse[i] = D4{prices[i]};
+            sink += coarse[r].raw_value();
+        }
+    });
+    const double batch_rescale = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            ash::decimal::rescale<4>(span, ash::make_span(coarse));
+            sink += coarse[r].raw_value();
+        }
+    });
+
+    const double scalar_double = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            for (std::size_t i = 0; i != prices.size(); ++i)
+                dbl[i] = prices[i].as_double();
+            sink += static_cast<long long>(dbl[r]);
+        }
+    });
+    const double batch_double = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            ash::decimal::to_double(span, ash::make_span(dbl));
+            sink += static_cast<long long>(dbl[r]);
+        }
+    });
+
+    std::vector<double> quotes(prices.size());
+    for (std::size_t i = 0; i != prices.size(); ++i)
+        quotes[i] = prices[i].as_double() / 1000;
+    const double naive_from = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            for (std::size_t i = 0; i != quotes.size(); ++i)
+                out[i] = D8::from_raw_value(std::llround(quotes[i] * 1e8));
+            sink += out[r].raw_value();
+        }
+    });
+    const double batch_from = time_ms([&] {
+        for (int r = 0; r != reps; ++r) {
+            ash::decimal::from_double(ash::make_span(quotes), ash::make_span(out));
+            sink += out[r].raw_value();
+        }
+    });
+
+    const double scalar_max = time_ms([&] {
+        for (int r = 0; r != reps; ++r)
+            sink += std::max_element(prices.begin(), prices.end())->raw_value();
+    });
+    const double batch_max = time_ms([&] {
+        for (int r = 0; r != reps; ++r)
+            sink += ash::decimal::max(span).raw_value();
+    });
+
+    std::cout
+        << "100k x " << reps << " fixed_decimal<8> (ms, scalar / batch)\n"
+        << "  sum       " << scalar_sum << " / " << batch_sum << '\n'
+        << "  scale     " << scalar_scale << " / " << batch_scale << '\n'
+        << "  mul       " << scalar_mul << " / " << batch_mul << '\n'
+        << "  rescale<4> " << scalar_rescale << " / " << batch_rescale << '\n'
+        << "  to_double " << scalar_double << " / " << batch_double << '\n'
+        << "  from_double (llround) " << naive_from << " / " << batch_from << '\n'
+        << "  max       " << scalar_max << " / " << batch_max << '\n';
+    CHECK(sink != 0);
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <ash/dynamic_decimal.h>
+
+namespace {
+
+using dec = ash::dynamic_decimal<>;
+using D2 = ash::fixed_decimal<2>;
+using D4 = ash::fixed_decimal<4>;
+using D8 = ash::fixed_decimal<8>;
+
+dec make(long long raw, unsigned char exponent)
+{
+    return dec::from_raw_value(raw, exponent);
+}
+
+std::string to_string(const dec& x)
+{
+    std::ostringstream ss;
+    ss << x;
+    return ss.str();
+}
+
+template<class R, class A, class B>
+void check_matches_fixed(std::mt19937_64& gen)
+{
+    for (int i = 0; i != 1000; ++i) {
+        const auto a = A::from_raw_value(static_cast<long long>(gen()) >> (gen() % 64));
+        const auto b = B::from_raw_value(static_cast<long long>(gen()) >> (gen() % 64));
+        const dec da{a}, db{b};
+
+        const R product = ash::multiply<ash::overflow::saturate, ash::rounding::half_even>(a, b);
+        const dec dp = ash::multiply<ash::overflow::saturate, ash::rounding::half_even>(da, db);
+        CHECK(dp.exponent() == R::exponent());
+        CHECK(dp.raw_value() == product.raw_value());
+
+        if (b.raw_value() != 0) {
+            const R quotient = ash::divide<ash::overflow::saturate, ash::rounding::half_up>(a, b);
+            const dec dq = ash::divide<ash::overflow::saturate, ash::rounding::half_up>(da, db);
+            CHECK(dq.raw_value() == quotient.raw_value());
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("dynamic_decimal construction", "[dynamic_decimal]")
+{
+    CHECK(dec::max_exponent() == 18);
+    CHECK(ash::dynamic_decimal<int>::max_exponent() == 9);
+
+    const dec zero;
+    CHECK(zero.raw_value() == 0);
+    CHECK(zero.exponent() == 0);
+
+    const dec px{D4::from_raw_value(1'234'567)};
+    CHECK(px.raw_value() == 1'234'567);
+    CHECK(px.exponent() == 4);
+    CHECK(px.multiplier() == 10'000);
+    CHECK(px.as_double() == Approx(123.4567));
+
+    CHECK(px.to_fixed<4>() == D4::from_raw_value(1'234'567));
+    CHECK(px.to_fixed<8>().raw_value() == 12'345'670'000);
+    CHECK(px.to_fixed<2>().raw_value() == 12'345);
+    CHECK((px.to_fixed<2, ash::overflow::wrap, ash::rounding::half_up>().raw_value() == 12'346));
+}
+
+TEST_CASE("dynamic_decimal rescale", "[dynamic_decimal]")
+{
+    const dec x = make(-1'250, 3);
+    CHECK(x.rescale(5).raw_value() == -125'000);
+    CHECK(x.rescale(5).exponent() == 5);
+    CHECK(x.rescale(1).raw_value() == -12);
+    CHECK((x.rescale<ash::overflow::wrap, ash::rounding::half_up>(1).raw_value() == -13));
+    CHECK((x.rescale<ash::overflow::wrap, ash::rounding::half_even>(1).raw_value() == -12));
+    CHECK((x.rescale<ash::overflow::wrap, ash::rounding::floor>(1).raw_value() == -13));
+    CHECK(x.rescale(0).raw_value() == -1);
+    CHECK((x.rescale<ash::overflow::wrap, ash::rounding::ceil>(0).raw_value() == -1));
+
+    const dec big = make(std::numeric_limits<long long>::max(), 2);
+    CHECK_THROWS_AS(big.rescale<ash::overflow::checked>(3), std::overflow_error);
+    CHECK(big.rescale<ash::overflow::saturate>(18).raw_value() ==
+            std::numeric_limits<long long>::max());
+    CHECK(big.rescale(0).raw_value() == std::numeric_limits<long long>::max() / 100);
+}
+
+TEST_CASE("dynamic_decimal table division", "[dynamic_decimal]")
+{
+    __extension__ typedef unsigned __int128 uint128;
+    std::mt19937_64 gen{7};
+    std::vector<unsigned long long> values = {
+        0, 1, 9, 10, 99, 100, std::numeric_limits<unsigned long long>::max()};
+    for (int i = 0; i != 10'000; ++i)
+        values.push_back(gen() >> (gen() % 64));
+
+    for (unsigned n = 0; n <= 19; ++n) {
+        INFO("10^" << n);
+        const auto d = ash::details::pow10_n<unsigned long long>(n);
+        for (auto v : values)
+            REQUIRE(ash::details::quot_pow10_n(v, n) == v / d);
+    }
+    for (unsigned n = 0; n <= 38; ++n) {
+        INFO("10^" << n);
+        const auto d = ash::details::pow10_n<uint128>(n);
+        for (auto v : values) {
+            const uint128 w = (uint128(v) << (v % 64)) | gen();
+            REQUIRE(ash::details::quot_pow10_n(w, n) == w / d);
+        }
+    }
+}
+
+TEST_CASE("dynamic_decimal comparison", "[dynamic_decimal]")
+{
+    CHECK(make(150, 2) == make(15, 1));
+    CHECK(make(150, 2) == D2::from_raw_value(150));
+    CHECK(make(150, 2) != make(151, 2));
+    CHECK(make(-1, 0) < make(-99'999, 5));
+    CHECK(make(1, 18) > make(0, 0));
+    CHECK(make(std::numeric_limits<long long>::max(), 0) >
+            make(std::numeric_limits<long long>::max(), 18));
+    CHECK(make(7, 3) <= make(7, 3));
+}
+
+TEST_CASE("dynamic_decimal arithmetic", "[dynamic_decimal]")
+{
+    SECTION("add and subtract") {
+        const auto sum = make(125, 2) + make(5, 1);
+        CHECK(sum.exponent() == 2);
+        CHECK(sum.raw_value() == 175);
+        CHECK((make(125, 2) - make(2, 0)).raw_value() == -75);
+        CHECK(-make(3, 1) == make(-30, 2));
+        CHECK_THROWS_AS(
+                ash::add<ash::overflow::checked>(
+                    make(std::numeric_limits<long long>::max(), 0), make(1, 0)),
+                std::overflow_error);
+    }
+
+    SECTION("subtract the most negative value") {
+        const auto lowest = std::numeric_limits<long long>::min();
+        CHECK(ash::subtract<ash::overflow::checked>(make(-1, 2), make(lowest, 2))
+                == make(std::numeric_limits<long long>::max(), 2));
+        CHECK_THROWS_AS(
+                ash::subtract<ash::overflow::checked>(make(0, 2), make(lowest, 2)),
+                std::overflow_error);
+        CHECK_THROWS_AS(
+                ash::subtract<ash::overflow::checked>(make(0, 3), make(lowest, 2)),
+                std::overflow_error);
+    }
+
+    SECTION("multiply and divide") {
+        CHECK(make(150, 2) * make(2, 0) == make(300, 2));
+        CHECK((make(150, 2) * make(25, 1)).raw_value() == 375);
+        CHECK((make(1, 0) / make(3, 2)).raw_value() == 3'333);
+        CHECK((ash::divide<ash::overflow::wrap, ash::rounding::half_up>(
+                        make(2, 0), make(3, 2))).raw_value() == 6'667);
+        CHECK_THROWS_AS(
+                ash::multiply<ash::overflow::checked>(
+                    make(100'000'000'000'000'000, 8), make(100'000'000'000'000'000, 8)),
+                std::overflow_error);
+    }
+
+    SECTION("matches fixed_decimal") {
+        std::mt19937_64 gen{11};
+        check_matches_fixed<D8, D8, D8>(gen);
+        check_matches_fixed<D8, D2, D8>(gen);
+        check_matches_fixed<D4, D4, D2>(gen);
+        check_matches_fixed<D2, ash::fixed_decimal<0>, D2>(gen);
+    }
+}
+
+TEST_CASE("dynamic_decimal to string", "[dynamic_decimal]")
+{
+    CHECK(to_string(make(1'234, 3)) == "1.234");
+    CHECK(to_string(make(-5, 3)) == "-0.005");
+    CHECK(to_string(make(42, 0)) == "42.");
+    CHECK(to_string(make(std::numeric_limits<long long>::min(), 18)) ==
+            "-9.223372036854775808");
+}
@@ -15,7 +15,15 @@
  * limitations under the License.
  */
 
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
 #include <sstream>
 
 #include <Catch/catch.hpp>
@@ -73,6 +81,243 @@ TEST_CASE("operations", "[fixed_decimal]")
     }
 }
 
+TEST_CASE("wide operations", "[fixed_decimal]")
+{
+    SECTION("multiplication") {
+        // 1e3 * 1e6 overflows long long at 8 decimals in a naive product.
+        CHECK(D8{1'000} * D8{1'000'000} == D8{1'000'000'000});
+        CHECK(D8::from_string("92233.72036854") * D8{-1'000'000} ==
+                D8::from_string("-92233720368.54"));
+        CHECK(D8{1.5} * D6{2} == D8{3});
+        CHECK(ash::multiply(D8{30'000}, 3) == D8{90'000});
+    }
+    SECTION("division") {
+        CHECK(D8{90'000} / D8{3} == D8{30'000});
+        CHECK(D8{1'000} / D8::from_string("0.001") == D8{1'000'000});
+        CHECK(D8{1} / D6{4} == D8{0.25});
+        CHECK(D6{3} / D8{2} == D8{1.5});
+    }
+}
+
+TEST_CASE("overflow policies", "[fixed_decimal]")
+{
+    const D8 big{500'000};
+    const D8 neg{-500'000};
+    const auto max = std::numeric_limits<long long>::max();
+    const auto min = std::numeric_limits<long long>::min();
+
+    SECTION("checked") {
+        using ash::overflow::checked;
+        CHECK(ash::multiply<checked>(big, D8{2}) == D8{1'000'000});
+        CHECK_THROWS_AS(ash::multiply<checked>(big, big), std::overflow_error);
+        CHECK_THROWS_AS(ash::multiply<checked>(big, max), std::overflow_error);
+        CHECK_THROWS_AS(ash::divide<checked>(big, D8::from_raw_value(1)),
+                std::overflow_error);
+        CHECK(ash::divide<checked>(big, D8{2}) == D8{250'000});
+    }
+    SECTION("saturate") {
+        using ash::overflow::saturate;
+        CHECK(ash::multiply<saturate>(big, big).raw_value() == max);
+        CHECK(ash::multiply<saturate>(big, neg).raw_value() == min);
+        CHECK(ash::multiply<saturate>(neg, max).raw_value() == min);
+        CHECK(ash::divide<saturate>(neg, D8::from_raw_value(1)).raw_value() == min);
+
+        using U2 = ash::ufixed_decimal<2>;
+        const auto umax = std::numeric_limits<unsigned long long>::max();
+        CHECK(ash::multiply<saturate>(U2{1'000'000'000'000}, U2{1'000'000'000'000})
+                .raw_value() == umax);
+    }
+}
+
+TEST_CASE("rounding modes", "[fixed_decimal]")
+{
+    using namespace ash::rounding;
+    using D0 = ash::fixed_decimal<0>;
+    const char* inputs[] = {
+        "2.5", "1.5", "1.4", "1.6", "0.001", "-0.001", "-1.4", "-1.5", "-2.5", "-1.6"};
+    const long long expected[][10] = {
+        { 2,  1,  1,  1,  0,  0, -1, -1, -2, -1},   // truncate
+        { 3,  2,  1,  2,  0,  0, -1, -2, -3, -2},   // half_up
+        { 2,  2,  1,  2,  0,  0, -1, -2, -2, -2},   // half_even
+        { 2,  1,  1,  1,  0, -1, -2, -2, -3, -2},   // floor
+        { 3,  2,  2,  2,  1,  0, -1, -1, -2, -1},   // ceil
+    };
+    for (int i = 0; i != 10; ++i) {
+        INFO(inputs[i]);
+        const auto x = D3::from_string(inputs[i]);
+        CHECK(ash::round_to<0, truncate>(x).raw_value() == expected[0][i]);
+        CHECK(ash::round_to<0, half_up>(x).raw_value() == expected[1][i]);
+        CHECK(ash::round_to<0, half_even>(x).raw_value() == expected[2][i]);
+        CHECK(ash::round_to<0, ash::rounding::floor>(x).raw_value() == expected[3][i]);
+        CHECK(ash::round_to<0, ash::rounding::ceil>(x).raw_value() == expected[4][i]);
+
+        CHECK(D0::from_raw_value<half_even>(x.raw_value(), 3).raw_value() ==
+                expected[2][i]);
+    }
+
+    SECTION("to more places") {
+        CHECK(ash::round_to<6, half_up>(D3::from_string("-1.305")) ==
+                D6::from_string("-1.305"));
+    }
+    SECTION("from_raw_value") {
+        CHECK(D3::from_raw_value<half_up>(123456, 5).raw_value() == 1235);
+        CHECK(D3::from_raw_value<ash::rounding::floor>(-123456, 5).raw_value() == -1235);
+        CHECK(D3::from_raw_value<ash::rounding::ceil>(1, 40).raw_value() == 1);
+        CHECK(D3::from_raw_value<half_up>(1, 40).raw_value() == 0);
+        CHECK(D3::from_raw_value(12, 1).raw_value() == 1200);
+    }
+    SECTION("multiply and divide") {
+        using ash::overflow::wrap;
+        const auto third = ash::divide<wrap, half_up>(D8{2}, D8{3});
+        CHECK(third.raw_value() == 66'666'667);
+        CHECK(ash::divide<wrap, ash::rounding::floor>(D8{-2}, D8{3}).raw_value() == -66'666'667);
+        CHECK((D8{2} / D8{3}).raw_value() == 66'666'666);
+
+        const auto x = D8::from_raw_value(150'000'001);     // 1.50000001
+        CHECK(ash::multiply<wrap, half_even>(x, x).raw_value() == 225'000'003);
+        CHECK(ash::multiply<wrap, truncate>(x, x).raw_value() == 225'000'003);
+        const auto h = D8::from_raw_value(5);               // 0.00000005
+        CHECK(ash::multiply<wrap, half_even>(h, D8{1.5}).raw_value() == 8);
+        CHECK(ash::multiply<wrap, half_even>(h, D8{2.5}).raw_value() == 12);
+        CHECK(ash::multiply<wrap, half_up>(h, D8{2.5}).raw_value() == 13);
+    }
+}
+
+#if defined(__SIZEOF_INT128__)
+TEST_CASE("wide reciprocal division", "[fixed_decimal]")
+{
+    __extension__ typedef __int128 int128;
+    std::mt19937_64 gen{3};
+    for (int i = 0; i != 100'000; ++i) {
+        const auto a = D8::from_raw_value(static_cast<long long>(gen()) >> (gen() % 64));
+        const auto b = D8::from_raw_value(static_cast<long long>(gen()) >> (gen() % 64));
+        const int128 exact = int128(a.raw_value()) * b.raw_value() / 100'000'000;
+        if (exact != static_cast<long long>(exact))
+            continue;
+        CHECK((a * b).raw_value() == static_cast<long long>(exact));
+    }
+}
+#endif
+
+TEST_CASE("reciprocal division", "[fixed_decimal]")
+{
+    std::mt19937_64 gen{5};
+    std::vector<long long> values = {
+        0, 1, -1, 9, 10, 99, 100,
+        std::numeric_limits<long long>::max(),
+        std::numeric_limits<long long>::min() + 1};
+    for (int i = 0; i != 10'000; ++i)
+        values.push_back(static_cast<long long>(gen()) >> (gen() % 64));
+
+    long long divisor = 1;
+    for (unsigned n = 0; n <= 18; ++n) {
+        INFO("10^" << n);
+        for (auto v : values) {
+            const auto x = D3::from_raw_value(v, static_cast<unsigned char>(3 + n));
+            REQUIRE(x.raw_value() == v / divisor);
+        }
+        if (n != 18)
+            divisor *= 10;
+    }
+    using U0 = ash::ufixed_decimal<0>;
+    const auto umax = std::numeric_limits<unsigned long long>::max();
+    CHECK(U0::from_raw_value(umax, 19).raw_value() == 1);
+    CHECK(U0::from_raw_value(umax, 18).raw_value() == 18);
+    CHECK(U0::from_raw_value(umax, 20).raw_value() == 0);
+}
+
+TEST_CASE("from_double", "[fixed_decimal]")
+{
+    using D2 = ash::fixed_decimal<2>;
+    using D0 = ash::fixed_decimal<0>;
+    using ash::from_double;
+    namespace rnd = ash::rounding;
+    const auto raw = [](auto x) { return x.raw_value(); };
+
+    SECTION("nearest") {
+        D2 x;
+        CHECK(D2{0.29}.raw_value() == 28);
+        CHECK(from_double(0.29, x) == std::errc{});
+        CHECK(raw(x) == 29);
+        CHECK(from_double(-0.29, x) == std::errc{});
+        CHECK(raw(x) == -29);
+        // 0.29 is stored slightly below 0.29.
+        CHECK(from_double<rnd::truncate>(0.29, x) == std::errc{});
+        CHECK(raw(x) == 28);
+    }
+
+    SECTION("ties") {
+        D2 x;
+        from_double<rnd::half_even>(0.125, x);
+        CHECK(raw(x) == 12);
+        from_double<rnd::half_up>(0.125, x);
+        CHECK(raw(x) == 13);
+        from_double<rnd::half_up>(-0.125, x);
+        CHECK(raw(x) == -13);
+        from_double<ash::rounding::floor>(-0.125, x);
+        CHECK(raw(x) == -13);
+        from_double<ash::rounding::ceil>(-0.125, x);
+        CHECK(raw(x) == -12);
+        from_double<rnd::truncate>(-0.125, x);
+        CHECK(raw(x) == -12);
+    }
+
+    SECTION("tiny and zero") {
+        D8 x;
+        CHECK(from_double(-0.0, x) == std::errc{});
+        CHECK(raw(x) == 0);
+        from_double(5e-324, x);
+        CHECK(raw(x) == 0);
+        from_double<ash::rounding::ceil>(5e-324, x);
+        CHECK(raw(x) == 1);
+        from_double<ash::rounding::floor>(-5e-324, x);
+        CHECK(raw(x) == -1);
+    }
+
+    SECTION("errors") {
+        D8 x = D8::from_raw_value(7);
+        CHECK(from_double(std::nan(""), x) == std::errc::invalid_argument);
+        CHECK(from_double(HUGE_VAL, x) == std::errc::invalid_argument);
+        CHECK(from_double(-HUGE_VAL, x) == std::errc::invalid_argument);
+        CHECK(from_double(1e300, x) == std::errc::result_out_of_range);
+        CHECK(from_double(1e11, x) == std::errc::result_out_of_range);
+        CHECK(raw(x) == 7);
+
+        D0 y;
+        CHECK(from_double(9223372036854775808.0, y) == std::errc::result_out_of_range);
+        CHECK(from_double(-9223372036854775808.0, y) == std::errc{});
+        CHECK(raw(y) == std::numeric_limits<long long>::min());
+        CHECK(from_double(9223372036854774784.0, y) == std::errc{});
+        CHECK(raw(y) == 9223372036854774784LL);
+
+        ash::ufixed_decimal<0> u;
+        CHECK(from_double(-1.0, u) == std::errc::result_out_of_range);
+        CHECK(from_double(-0.25, u) == std::errc{});
+        CHECK(u.raw_value() == 0);
+    }
+
+    SECTION("matches printf") {
+        // glibc prints the exact binary value rounded half to even.
+        std::mt19937_64 gen{9};
+        std::uniform_real_distribution<double> dist{-1e6, 1e6};
+        char buf[64];
+        for (int i = 0; i != 100'000; ++i) {
+            double v = dist(gen);
+            if (i % 3 == 0)
+                v = std::round(v * 1e4) / 1e4;
+            if (i % 3 == 1)
+                v = std::ldexp(std::round(std::ldexp(v, 20)), -20 - int(gen() % 20));
+            std::snprintf(buf, sizeof(buf), "%.8f", v);
+            std::string digits{buf};
+            digits.erase(digits.find('.'), 1);
+            D8 x;
+            REQUIRE(from_double(v, x) == std::errc{});
+            INFO(buf);
+            REQUIRE(raw(x) == std::strtoll(digits.c_str(), nullptr, 10));
+        }
+    }
+}
+
 TEST_CASE("static creations", "[fixed_decimal]")
 {
     SECTION("from_raw_value") {
@@ -118,5 +363,9 @@ TEST_CASE("to string", "[fixed_decimal]")
             ss << D3::from_string("-1.305");
             CHECK(ss.str() == "-1.305");
         }
+        SECTION("negative fraction") {
+            ss << D3::from_raw_value(-5);
+            CHECK(ss.str() == "-0.005");
+        }
     }
 }
@@ -15,7 +15,15 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <Catch/catch.hpp>
 
@@ -129,6 +137,36 @@ TEST_CASE("append", "[fixed_string]")
     }
 }
 
+TEST_CASE("append numbers", "[fixed_string]")
+{
+    ash::fixed_string<16> s{"38="};
+    s.append(-250).append('|').append(ash::fixed_decimal<2>::from_raw_value(1050),
+            ash::trailing_zeros::trim);
+    CHECK(s.str() == "38=-250|10.5");
+    s += 7u;
+    CHECK(s.str() == "38=-250|10.57");
+
+    ash::fixed_string<8> px;
+    px.append(101.125, 2);
+    CHECK(px.str() == "101.12");
+    CHECK(px.try_append(3.0, 2) == std::errc::value_too_large);
+    CHECK(px.str() == "101.12");
+    CHECK_THROWS_AS(px.append(1234), std::length_error);
+    CHECK(px.str() == "101.12");
+    CHECK_THROWS_AS(px.append(std::nan(""), 2), std::invalid_argument);
+    CHECK(px.try_append(12) == std::errc{});
+    CHECK(px.length() == 8);
+    CHECK(px.str() == "101.1212");
+    CHECK(px.try_append(0) == std::errc::value_too_large);
+
+    // Appending writes the terminator over stale bytes.
+    ash::fixed_string<8> t{"1234567"};
+    t.clear();
+    t.append(42);
+    CHECK(t.length() == 2);
+    CHECK(t.str() == "42");
+}
+
 TEST_CASE("hashable", "[fixed_string, hash]")
 {
     std::unordered_map<ash::fixed_string<4>, char> m;
@@ -139,6 +177,39 @@ TEST_CASE("hashable", "[fixed_string, hash]")
     CHECK(m["XYZ"] == 8);
 }
 
+TEST_CASE("hash distribution", "[fixed_string, hash]")
+{
+    const std::hash<S8> h8;
+    SECTION("ignores bytes past the terminator") {
+        S8 s{"abcdef"};
+        s[3] = '\0';
+        CHECK(s == S8{"abc"});
+        CHECK(h8(s) == h8(S8{"abc"}));
+        CHECK(h8(S8{"abc"}) != h8(S8{"abcd"}));
+        CHECK(h8(S8{}) != h8(S8{"\x01"}));
+    }
+    SECTION("long strings keep their first bytes") {
+        using S100 = ash::fixed_string<100>;
+        const std::hash<S100> h;
+        const std::string tail(90, 'x');
+        CHECK(h(S100{"a" + tail}) != h(S100{"b" + tail}));
+        CHECK(h(S100{tail + "a"}) != h(S100{tail + "b"}));
+    }
+    SECTION("shared prefixes") {
+        constexpr std::size_t n = 100'000;
+        constexpr std::size_t buckets = 1 << 16;
+        std::vector<std::size_t> hashes, load(buckets);
+        for (std::size_t i = 0; i != n; ++i) {
+            const S16 sym{"SYM" + std::to_string(i)};
+            hashes.push_back(std::hash<S16>{}(sym));
+            ++load[hashes.back() % buckets];
+        }
+        std::sort(hashes.begin(), hashes.end());
+        CHECK(std::unique(hashes.begin(), hashes.end()) == hashes.end());
+        CHECK(*std::max_element(load.begin(), load.end()) < 16);
+    }
+}
+
 TEST_CASE("swap", "[fixed_string]")
 {
     S4 a{"abcd"}, w{"wxyz"};
@@ -165,5 +236,193 @@ TEST_CASE("find", "[fixed_string]")
         const S4 very{"very"};
         CHECK(very.find("very") == 0);
         CHECK(very.find("very", 1) == S4::npos);
+
+        const S16 partial{"aaab"};
+        CHECK(partial.find("aab") == 1);
+        CHECK(partial.find("") == 0);
+    }
+    SECTION("ignores characters past the end") {
+        S16 s{"hello world"};
+        s.clear();
+        CHECK(s.find('o') == S16::npos);
+        CHECK(s.find("world") == S16::npos);
+        CHECK(s == S16{});
+    }
+}
+
+TEST_CASE("rfind and find_first_of", "[fixed_string]")
+{
+    const S21 s{"abcabcabc-abcabcabcXY"};
+    CHECK(s.rfind('a') == 16);
+    CHECK(s.rfind('a', 15) == 13);
+    CHECK(s.rfind('a', 0) == 0);
+    CHECK(s.rfind('z') == S21::npos);
+    CHECK(s.rfind("abc") == 16);
+    CHECK(s.rfind("abc", 15) == 13);
+    CHECK(s.rfind("XY") == 19);
+    CHECK(s.find_first_of("-X") == 9);
+    CHECK(s.find_first_of("YX", 10) == 19);
+    CHECK(s.find_first_of("xyz") == S21::npos);
+    CHECK(S4{}.rfind('a') == S4::npos);
+}
+
+TEST_CASE("ordering", "[fixed_string, comparison]")
+{
+    CHECK(S8{"abc"} < S8{"abd"});
+    CHECK(S8{"ab"} < S8{"abc"});
+    CHECK_FALSE(S8{"abc"} < S8{"abc"});
+    CHECK(S4{"abcd"} < S8{"abcde"});
+    CHECK(S8{"abcd"} == S4{"abcd"});
+    CHECK_FALSE(S8{"abcde"} == S4{"abcd"});
+    CHECK(S16{"abcdefghijklmnop"} > S16{"abcdefghijklmnoa"});
+}
+
+namespace {
+
+template<std::size_t N>
+void check_against_std(std::mt19937& gen)
+{
+    std::uniform_int_distribution<std::size_t> len(0, N);
+    std::uniform_int_distribution<int> letter('a', 'c');
+    const auto random_string = [&](std::size_t n) {
+        std::string s;
+        for (std::size_t i = 0; i != n; ++i)
+            s.push_back(static_cast<char>(letter(gen)));
+        return s;
+    };
+
+    for (int iter = 0; iter != 2'000; ++iter) {
+        const std::string str = random_string(len(gen));
+        const std::string other = random_string(len(gen));
+        const std::string needle = random_string(len(gen) % 4);
+        const ash::fixed_string<N> s{str};
+        const ash::fixed_string<N> t{other};
+        const std::size_t pos = len(gen);
+        const char ch = static_cast<char>(letter(gen));
+        REQUIRE(s.find(ch, pos) == str.find(ch, pos));
+        REQUIRE(s.rfind(ch, pos) == str.rfind(ch, pos));
+        REQUIRE(s.find(needle.c_str(), pos) == str.find(needle, pos));
+        REQUIRE(s.rfind(needle.c_str(), pos) == str.rfind(needle, pos));
+        REQUIRE(s.find_first_of(needle.c_str(), pos) ==
+                str.find_first_of(needle, pos));
+        REQUIRE((s == t) == (str == other));
+        REQUIRE((s < t) == (str < other));
     }
 }
+
+} // namespace
+
+TEST_CASE("search matches std::string", "[fixed_string]")
+{
+    std::mt19937 gen{45};
+    check_against_std<1>(gen);
+    check_against_std<7>(gen);
+    check_against_std<16>(gen);
+    check_against_std<17>(gen);
+    check_against_std<40>(gen);
+}
+
+TEST_CASE("fixed string benchmark", "[.][benchmark][fixed_string]")
+{
+    using S32 = ash::fixed_string<32>;
+    constexpr int iterations = 200;
+    std::mt19937 gen{45};
+    std::uniform_int_distribution<int> letter('A', 'Z');
+    std::vector<S32> symbols;
+    for (int i = 0; i != 10'000; ++i) {
+        std::string s(8 + i % 24, ' ');
+        for (auto& c : s)
+            c = static_cast<char>(letter(gen));
+        symbols.emplace_back(s);
+    }
+
+    // The implementations these replaced.
+    const auto naive_find_char = [](const S32& s, char ch) {
+        for (std::size_t i = 0; i != s.capacity(); ++i) {
+            if (s[i] == ch)
+                return i;
+            else if (s[i] == '\0')
+                return S32::npos;
+        }
+        return S32::npos;
+    };
+    const auto naive_find = [](const S32& s, const char* n) {
+        std::size_t d = 0, k = 0;
+        while (d + k != s.capacity() and n[k] != '\0') {
+            if (s[d + k] == n[k]) {
+                ++k;
+            } else {
+                ++d;
+                k = 0;
+            }
+        }
+        return n[k] == '\0' ? d : S32::npos;
+    };
+    const auto naive_equal = [](const S32& a, const S32& b) {
+        const std::size_t len = a.length();
+        if (len != b.length()) return false;
+        for (std::size_t i = 0; i != len; ++i)
+            if (a[i] != b[i]) return false;
+        return true;
+    };
+    const auto naive_less = [](const S32& a, const S32& b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+    };
+
+    const auto time_ms = [&](auto&& f) {
+        std::size_t sink = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it != iterations; ++it) {
+            for (std::size_t i = 1; i != symbols.size(); ++i)
+                sink += f(symbols[i - 1], symbols[i]);
+        }
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        CHECK(sink != 1);
+        return elapsed.count();
+    };
+
+    std::cout
+        << "2M operations on fixed_string<32>   naive / simd\n"
+        << "  find(char)     "
+        << time_ms([&](auto& a, auto&) { return naive_find_char(a, 'Q'); }) << " / "
+        << time_ms([&](auto& a, auto&) { return a.find('Q'); }) << " ms\n"
+        << "  find(\"XYZ\")    "
+        << time_ms([&](auto& a, auto&) { return naive_find(a, "XYZ"); }) << " / "
+        << time_ms([&](auto& a, auto&) { return a.find("XYZ"); }) << " ms\n"
+        << "  operator==     "
+        << time_ms([&](auto& a, auto& b) { return naive_equal(a, a) + naive_equal(a, b); }) << " / "
+        << time_ms([&](auto& a, auto& b) { return (a == a) + (a == b); }) << " ms\n"
+        << "  operator<      "
+        << time_ms([&](auto& a, auto& b) { return naive_less(a, b); }) << " / "
+        << time_ms([&](auto& a, auto& b) { return a < b; }) << " ms\n";
+
+    // The hash this replaced.
+    struct naive_hash
+    {
+        std::size_t operator()(const S32& src) const
+        {
+            std::size_t h = 0;
+            for (char c : src)
+                (h <<= 1) ^= static_cast<unsigned char>(c);
+            return h;
+        }
+    };
+    const auto lookup_ms = [&](auto map) {
+        for (std::size_t i = 0; i != symbols.size(); ++i)
+            map.emplace(symbols[i], i);
+        return time_ms([&](auto& a, auto&) { return map.count(a); });
+    };
+    std::cout
+        << "  map lookup     "
+        << lookup_ms(std::unordered_map<S32, std::size_t, naive_hash>{}) << " / "
+        << lookup_ms(std::unordered_map<S32, std::size_t>{}) << " ms\n";
+
+    // Option symbols share all but their strike.
+    for (std::size_t i = 0; i != symbols.size(); ++i)
+        symbols[i] = S32{"SPXW  261218C0" + std::to_string(100'000 + i * 5)};
+    std::cout
+        << "  option lookup  "
+        << lookup_ms(std::unordered_map<S32, std::size_t, naive_hash>{}) << " / "
+        << lookup_ms(std::unordered_map<S32, std::size_t>{}) << " ms\n";
+}
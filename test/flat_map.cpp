@@ -0,0 +1,252 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Catch/catch.hpp>
+
+#include <ash/fixed_string.h>
+#include <ash/flat_map.h>
+#include <ash/sized_string.h>
+
+using symbol = ash::fixed_string<16>;
+
+TEST_CASE("flat_map basics", "[flat_map]")
+{
+    ash::flat_map<symbol, int> m;
+    CHECK(m.empty());
+    CHECK(m.find(symbol{"IBM"}) == m.end());
+    CHECK(m.begin() == m.end());
+
+    CHECK(m.emplace(symbol{"IBM"}, 1).second);
+    CHECK_FALSE(m.emplace(symbol{"IBM"}, 2).second);
+    m[symbol{"MSFT"}] = 3;
+    CHECK(m.size() == 2);
+    CHECK(m.at(symbol{"IBM"}) == 1);
+    CHECK(m[symbol{"MSFT"}] == 3);
+    CHECK(m.count(symbol{"AAPL"}) == 0);
+    CHECK_THROWS_AS(m.at(symbol{"AAPL"}), std::out_of_range);
+
+    auto it = m.find(symbol{"IBM"});
+    REQUIRE(it != m.end());
+    CHECK(it->first == "IBM");
+    it->second = 7;
+    CHECK(m.at(symbol{"IBM"}) == 7);
+
+    CHECK(m.erase(symbol{"IBM"}) == 1);
+    CHECK(m.erase(symbol{"IBM"}) == 0);
+    CHECK(m.size() == 1);
+    m.clear();
+    CHECK(m.empty());
+    CHECK(m.find(symbol{"MSFT"}) == m.end());
+}
+
+TEST_CASE("flat_map matches std::unordered_map", "[flat_map]")
+{
+    std::mt19937 gen{47};
+    std::uniform_int_distribution<int> key(0, 5'000);
+    std::uniform_int_distribution<int> op(0, 3);
+    ash::flat_map<int, std::string> m;
+    std::unordered_map<int, std::string> ref;
+
+    for (int i = 0; i != 100'000; ++i) {
+        const int k = key(gen);
+        switch (op(gen)) {
+        case 0:
+        case 1:
+            m[k] = std::to_string(i);
+            ref[k] = std::to_string(i);
+            break;
+        case 2:
+            REQUIRE(m.erase(k) == ref.erase(k));
+            break;
+        default:
+            REQUIRE(m.count(k) == ref.count(k));
+            if (ref.count(k))
+                REQUIRE(m.at(k) == ref.at(k));
+        }
+    }
+    REQUIRE(m.size() == ref.size());
+    std::size_t seen = 0;
+    for (const auto& kv : m) {
+        REQUIRE(ref.at(kv.first) == kv.second);
+        ++seen;
+    }
+    CHECK(seen == ref.size());
+
+    for (auto it = m.begin(); it != m.end();)
+        it = it->first % 2 ? m.erase(it) : std::next(it);
+    for (const auto& kv : ref)
+        CHECK(m.count(kv.first) == (kv.first % 2 == 0));
+}
+
+TEST_CASE("flat_map without rehash", "[flat_map]")
+{
+    ash::flat_map<int, int> m;
+    m.reserve(100);
+    const std::size_t cap = m.capacity();
+    m.allow_rehash(false);
+
+    m[0] = 0;
+    const int* first = &m[0];
+    int n = 1;
+    try {
+        for (;; ++n)
+            m[n] = n;
+    } catch (const std::length_error&) {
+    }
+    CHECK(n >= 100);
+    CHECK(m.capacity() == cap);
+    CHECK(&m[0] == first);
+
+    m.reserve(m.size());
+    CHECK_THROWS_AS(m.reserve(2 * cap), std::length_error);
+    CHECK(m.capacity() == cap);
+    CHECK(&m[0] == first);
+
+    // Churn within the reserved size keeps fitting.
+    for (int i = 0; i != 10'000; ++i) {
+        m.erase(i % n);
+        m[i % n] = i;
+    }
+    CHECK(m.capacity() == cap);
+    CHECK(m.size() == static_cast<std::size_t>(n));
+}
+
+TEST_CASE("flat_map copy without rehash", "[flat_map]")
+{
+    ash::flat_map<int, int> m;
+    m.reserve(1000);
+    m.allow_rehash(false);
+    for (int i = 0; i != 3; ++i)
+        m[i] = i;
+
+    auto copy = m;
+    CHECK_FALSE(copy.rehash_allowed());
+    CHECK(copy.capacity() == m.capacity());
+    for (int i = 0; i != 1000; ++i)
+        copy[i] = i;
+    CHECK(copy.size() == 1000);
+    CHECK(copy.capacity() == m.capacity());
+
+    ash::flat_map<int, int> assigned;
+    assigned = m;
+    CHECK(assigned.capacity() == m.capacity());
+}
+
+TEST_CASE("flat_map string keys", "[flat_map]")
+{
+    SECTION("fixed_string ignores characters past the terminator") {
+        ash::flat_map<symbol, int> m;
+        symbol stale{"abcdef"};
+        stale[3] = '\0';
+        m[stale] = 1;
+        CHECK(m.count(symbol{"abc"}) == 1);
+        CHECK(m.count(symbol{"abcdef"}) == 0);
+        m[symbol{"abcdefghijklmnop"}] = 2;
+        CHECK(m.at(symbol{"abcdefghijklmnop"}) == 2);
+        CHECK(m.count(symbol{"abcdefghijklmno"}) == 0);
+    }
+    SECTION("sized_string") {
+        ash::flat_map<ash::sized_string<8>, int> m;
+        for (int i = 0; i != 1000; ++i)
+            m[ash::sized_string<8>{std::to_string(i)}] = i;
+        CHECK(m.size() == 1000);
+        CHECK(m.at(ash::sized_string<8>{"999"}) == 999);
+        CHECK(m.count(ash::sized_string<8>{"1000"}) == 0);
+    }
+    SECTION("long keys and custom hashes") {
+        ash::flat_map<ash::fixed_string<32>, int> m;
+        m[ash::fixed_string<32>{"a long key that needs two blocks"}] = 1;
+        CHECK(m.count(ash::fixed_string<32>{"a long key that needs two blocks"}) == 1);
+
+        struct constant_hash
+        {
+            std::size_t operator()(int) const { return 7; }
+        };
+        ash::flat_map<int, int, constant_hash> c;
+        for (int i = 0; i != 100; ++i)
+            c[i] = i;
+        for (int i = 0; i != 100; ++i)
+            CHECK(c.at(i) == i);
+    }
+}
+
+TEST_CASE("flat_map copy and move", "[flat_map]")
+{
+    ash::flat_map<symbol, std::string> m;
+    for (int i = 0; i != 100; ++i)
+        m[symbol{"S" + std::to_string(i)}] = std::to_string(i);
+
+    auto copy = m;
+    CHECK(copy.size() == 100);
+    CHECK(copy.at(symbol{"S42"}) == "42");
+
+    auto moved = std::move(copy);
+    CHECK(moved.size() == 100);
+    CHECK(copy.empty());
+    CHECK(copy.find(symbol{"S42"}) == copy.end());
+
+    copy = moved;
+    moved.clear();
+    CHECK(copy.at(symbol{"S99"}) == "99");
+}
+
+TEST_CASE("flat_map benchmark", "[.][benchmark][flat_map]")
+{
+    std::mt19937 gen{47};
+    std::uniform_int_distribution<int> letter('A', 'Z');
+    std::vector<symbol> keys;
+    for (int i = 0; i != 5'000; ++i) {
+        std::string s(3 + i % 6, ' ');
+        for (auto& c : s)
+            c = static_cast<char>(letter(gen));
+        keys.emplace_back(s);
+    }
+    std::vector<symbol> probes;
+    std::uniform_int_distribution<std::size_t> pick(0, keys.size() - 1);
+    for (int i = 0; i != 50'000; ++i)
+        probes.push_back(keys[pick(gen)]);
+
+    const auto time_ms = [&](auto& map) {
+        for (std::size_t i = 0; i != keys.size(); ++i)
+            map[keys[i]] = i;
+        std::size_t sink = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep != 100; ++rep) {
+            for (const auto& p : probes)
+                sink += map.find(p)->second;
+        }
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        CHECK(sink != 1);
+        return elapsed.count();
+    };
+
+    std::unordered_map<symbol, std::size_t> std_map;
+    ash::flat_map<symbol, std::size_t> flat;
+    std::cout
+        << "5M lookups, 5k fixed_string<16> keys\n"
+        << "  std::unordered_map  " << time_ms(std_map) << " ms\n"
+        << "  ash::flat_map       " << time_ms(flat) << " ms\n";
+}
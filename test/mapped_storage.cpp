@@ -0,0 +1,163 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <ash/mapped_storage.h>
+
+namespace {
+
+struct record {
+    long long id;
+    double price;
+};
+
+struct temp_path {
+    temp_path() :
+        path{"/tmp/ash_mapped_storage_" + std::to_string(::getpid())}
+    {
+        std::remove(path.c_str());
+    }
+
+    ~temp_path()
+    {
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+} // namespace
+
+TEST_CASE("mapped storage create", "[mapped_storage]")
+{
+    temp_path tmp;
+    ash::mapped_storage<record> store{tmp.path, 4096};
+    CHECK(store.empty());
+    CHECK(store.begin() == store.end());
+
+    auto& first = store.create(record{1, 1.5});
+    const auto n = 3 * store.capacity();
+    for (std::size_t i = 1; i != n; ++i)
+        store.create(record{static_cast<long long>(i + 1), 0.0});
+    CHECK(store.size() == n);
+    CHECK(store.chunk_count() >= 2);
+    CHECK(first.id == 1);
+
+    long long expected = 1;
+    for (const auto& r : store)
+        CHECK(r.id == expected++);
+}
+
+TEST_CASE("mapped storage reopen", "[mapped_storage]")
+{
+    temp_path tmp;
+    {
+        ash::mapped_storage<record> store{tmp.path, 4096};
+        for (long long i = 0; i != 1000; ++i)
+            store.create(record{i, i * 0.5});
+        store.checkpoint();
+    }
+
+    ash::mapped_storage<record> store{tmp.path};
+    REQUIRE(store.size() == 1000);
+    long long sum = 0;
+    store.for_each([&](const record& r) { sum += r.id; });
+    CHECK(sum == 999 * 1000 / 2);
+
+    store.create(record{1000, 0.0});
+    CHECK(store.size() == 1001);
+
+    SECTION("incompatible record") {
+        CHECK_THROWS(ash::mapped_storage<char>{tmp.path});
+    }
+}
+
+TEST_CASE("mapped storage recovers the last checkpoint", "[mapped_storage]")
+{
+    temp_path tmp;
+    {
+        ash::mapped_storage<record> store{tmp.path, 4096};
+        for (long long i = 0; i != 100; ++i)
+            store.create(record{i, 0.0});
+        store.checkpoint();
+        for (long long i = 100; i != 1000; ++i)
+            store.create(record{i, 0.0});
+        CHECK(store.size() == 1000);
+    }
+    {
+        ash::mapped_storage<record> store{tmp.path};
+        CHECK(store.size() == 100);
+        store.clear();
+        CHECK(store.empty());
+    }
+
+    ash::mapped_storage<record> store{tmp.path};
+    CHECK(store.size() == 100);
+    CHECK(store.begin()->id == 0);
+}
+
+TEST_CASE("mapped storage create after clear", "[mapped_storage]")
+{
+    temp_path tmp;
+    {
+        ash::mapped_storage<record> store{tmp.path, 4096};
+        for (long long i = 0; i != 100; ++i)
+            store.create(record{i, 0.0});
+        store.checkpoint();
+        store.clear();
+        store.create(record{-1, 0.0});
+    }
+    {
+        // The overwritten checkpoint is gone, nothing after it was committed.
+        ash::mapped_storage<record> store{tmp.path};
+        CHECK(store.empty());
+        store.create(record{-2, 0.0});
+        store.create(record{-3, 0.0});
+        store.checkpoint();
+    }
+
+    ash::mapped_storage<record> store{tmp.path};
+    REQUIRE(store.size() == 2);
+    CHECK(store.begin()->id == -2);
+}
+
+TEST_CASE("mapped storage rejects another page size", "[mapped_storage]")
+{
+    temp_path tmp;
+    {
+        ash::mapped_storage<record> store{tmp.path};
+        store.create(record{1, 1.0});
+        store.checkpoint();
+    }
+
+    // page_size follows the magic, version, record size and alignment.
+    const int fd = ::open(tmp.path.c_str(), O_RDWR);
+    REQUIRE(fd != -1);
+    const std::uint32_t other = 2 * static_cast<std::uint32_t>(::sysconf(_SC_PAGESIZE));
+    CHECK(::pwrite(fd, &other, sizeof(other), 20) == sizeof(other));
+    ::close(fd);
+
+    CHECK_THROWS_AS(ash::mapped_storage<record>{tmp.path}, std::runtime_error);
+}
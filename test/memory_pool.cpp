@@ -49,3 +49,21 @@ SCENARIO("memory pool reuses memory", "[memory_pool]")
         }
     }
 }
+
+TEST_CASE("pool allocator reuses memory", "[memory_pool]")
+{
+    ash::pool_allocator<double> alloc;
+    double* a = alloc.allocate(1);
+    alloc.deallocate(a, 1);
+    double* b = alloc.allocate(1);
+    CHECK(a == b);
+    double* c = alloc.allocate(1);
+    CHECK(c != b);
+    alloc.deallocate(b, 1);
+    alloc.deallocate(c, 1);
+
+    double* many = alloc.allocate(16);
+    many[15] = 1.0;
+    alloc.deallocate(many, 16);
+    CHECK(alloc == ash::pool_allocator<int>{});
+}
@@ -17,6 +17,9 @@
 
 #include <Catch/catch.hpp>
 
+#include <stdexcept>
+#include <string>
+
 #include <ash/multipart.h>
 
 struct no_default {
@@ -48,3 +51,66 @@ TEST_CASE("make", "[multipart]")
     m.make<no_default>(1);
     CHECK(m.get_ptr<no_default>());
 }
+
+TEST_CASE("lazy get", "[multipart]")
+{
+    ash::multipart<int, std::string> m{nullptr};
+    REQUIRE(m.get_ptr<std::string>() == nullptr);
+    m.get<std::string>() = "lazy";
+    CHECK(m.get_ptr<std::string>() != nullptr);
+    CHECK(m.get<std::string>() == "lazy");
+    CHECK(m.get_ptr<int>() == nullptr);
+
+    m.reset<std::string>();
+    CHECK(m.get_ptr<std::string>() == nullptr);
+}
+
+TEST_CASE("get of a part never made", "[multipart]")
+{
+    ash::multipart<int, no_default> m{nullptr};
+    CHECK_THROWS_AS(m.get<no_default>(), std::logic_error);
+
+    const auto& cm = m;
+    CHECK_THROWS_AS(cm.get<int>(), std::logic_error);
+    m.make<int>(4);
+    CHECK(cm.get<int>() == 4);
+}
+
+TEST_CASE("pooled parts", "[multipart]")
+{
+    using message = ash::pooled_multipart<long long, std::string>;
+    const long long* first = nullptr;
+    {
+        message m{nullptr};
+        m.make<long long>(42);
+        first = m.get_ptr<long long>();
+        CHECK(m.get<long long>() == 42);
+    }
+    message m{nullptr};
+    m.make<long long>(7);
+    CHECK(m.get_ptr<long long>() == first);
+    m.get<std::string>() = "pooled";
+    CHECK(m.get<std::string>() == "pooled");
+
+    message moved{std::move(m)};
+    CHECK(m.get_ptr<long long>() == nullptr);
+    CHECK(moved.get<long long>() == 7);
+}
+
+TEST_CASE("pooled default construction", "[multipart]")
+{
+    using message = ash::pooled_multipart<long long, std::string>;
+    const long long* freed = nullptr;
+    {
+        message m{nullptr};
+        m.make<long long>(1);
+        freed = m.get_ptr<long long>();
+    }
+    message m;
+    CHECK(m.get_ptr<long long>() == nullptr);
+    CHECK(m.get_ptr<std::string>() == nullptr);
+
+    // The block released above is still free for the first real part.
+    m.make<long long>(2);
+    CHECK(m.get_ptr<long long>() == freed);
+}
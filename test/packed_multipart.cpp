@@ -0,0 +1,162 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ash/packed_multipart.h>
+
+namespace {
+
+struct no_default {
+    no_default() = delete;
+    no_default(int v) : value{v} { }
+    int value;
+};
+
+struct alignas(32) wide {
+    double lanes[4];
+};
+
+struct counted {
+    counted() { ++alive; }
+    ~counted() { --alive; }
+    static int alive;
+};
+
+int counted::alive = 0;
+
+std::vector<int> destroyed;
+
+template<int N>
+struct logged {
+    ~logged() { destroyed.push_back(N); }
+};
+
+struct fragile {
+    fragile(int v) : value{v}
+    {
+        if (v < 0)
+            throw std::invalid_argument("negative");
+    }
+    int value;
+};
+
+} // namespace
+
+TEST_CASE("packed multipart constructor", "[packed_multipart]")
+{
+    SECTION("default") {
+        ash::packed_multipart<int, char, std::string> m;
+        m.get<int>() = 3;
+        m.get<char>() = 'a';
+        m.get<std::string>() = "abc";
+        CHECK(m.get<int>() == 3);
+        CHECK(m.get<char>() == 'a');
+        CHECK(m.get<std::string>() == "abc");
+    }
+    SECTION("nullptr") {
+        ash::packed_multipart<int, no_default> m{nullptr};
+        CHECK(m.get_ptr<int>() == nullptr);
+        CHECK(m.get_ptr<no_default>() == nullptr);
+    }
+    SECTION("destructor") {
+        {
+            ash::packed_multipart<counted, int, counted*> m;
+            CHECK(counted::alive == 1);
+        }
+        CHECK(counted::alive == 0);
+    }
+}
+
+TEST_CASE("packed multipart layout", "[packed_multipart]")
+{
+    ash::packed_multipart<char, wide, int> m;
+    auto base = reinterpret_cast<std::uintptr_t>(m.get_ptr<char>());
+    auto* w = m.get_ptr<wide>();
+    auto* i = m.get_ptr<int>();
+    CHECK(reinterpret_cast<std::uintptr_t>(w) % alignof(wide) == 0);
+    CHECK(reinterpret_cast<std::uintptr_t>(w) - base == alignof(wide));
+    CHECK(reinterpret_cast<std::uintptr_t>(i) - base ==
+            alignof(wide) + sizeof(wide));
+}
+
+TEST_CASE("packed multipart make", "[packed_multipart]")
+{
+    ash::packed_multipart<int, no_default> m{nullptr};
+    REQUIRE(m.get_ptr<no_default>() == nullptr);
+    m.make<no_default>(1);
+    REQUIRE(m.get_ptr<no_default>());
+    CHECK(m.get<no_default>().value == 1);
+    CHECK(m.get_ptr<int>() == nullptr);
+    m.make<no_default>(2);
+    CHECK(m.get<no_default>().value == 2);
+}
+
+TEST_CASE("packed multipart get of a part never made", "[packed_multipart]")
+{
+    ash::packed_multipart<int, ash::cold<std::string>> m{nullptr};
+    CHECK_THROWS_AS(m.get<int>(), std::logic_error);
+    CHECK_THROWS_AS(m.get<std::string>(), std::logic_error);
+
+    m.make<int>(7);
+    const auto& cm = m;
+    CHECK(cm.get<int>() == 7);
+    CHECK_THROWS_AS(cm.get<std::string>(), std::logic_error);
+}
+
+TEST_CASE("packed multipart cold parts", "[packed_multipart]")
+{
+    ash::packed_multipart<int, ash::cold<std::string>> m;
+    CHECK(m.get_ptr<int>() != nullptr);
+    CHECK(m.get_ptr<std::string>() == nullptr);
+    m.make<std::string>("rarely used");
+    CHECK(m.get<std::string>() == "rarely used");
+
+    auto moved = std::move(m);
+    CHECK(m.get_ptr<int>() == nullptr);
+    CHECK(m.get_ptr<std::string>() == nullptr);
+    CHECK(moved.get<std::string>() == "rarely used");
+}
+
+TEST_CASE("packed multipart make keeps the old part on throw", "[packed_multipart]")
+{
+    ash::packed_multipart<int, fragile, std::string> m{nullptr};
+    m.make<fragile>(1);
+    CHECK_THROWS_AS(m.make<fragile>(-1), std::invalid_argument);
+    REQUIRE(m.get_ptr<fragile>() != nullptr);
+    CHECK(m.get<fragile>().value == 1);
+
+    CHECK_THROWS_AS(m.make<std::string>(std::string(), 1), std::out_of_range);
+    m.make<std::string>("kept");
+    CHECK_THROWS_AS(m.make<std::string>(std::string(), 1), std::out_of_range);
+    CHECK(m.get<std::string>() == "kept");
+}
+
+TEST_CASE("packed multipart destroys in reverse order", "[packed_multipart]")
+{
+    destroyed.clear();
+    {
+        ash::packed_multipart<logged<1>, ash::cold<logged<2>>, logged<3>> m;
+        m.make<logged<2>>();
+    }
+    CHECK(destroyed == (std::vector<int>{3, 2, 1}));
+}
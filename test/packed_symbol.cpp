@@ -0,0 +1,165 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <Catch/catch.hpp>
+
+#include <ash/packed_symbol.h>
+
+using P8 = ash::packed_symbol<8>;
+using P16 = ash::packed_symbol<16>;
+using A10 = ash::packed_symbol<10, ash::packing::alnum6>;
+using A20 = ash::packed_symbol<20, ash::packing::alnum6>;
+
+TEST_CASE("packed_symbol layout", "[packed_symbol]")
+{
+    static_assert(sizeof(P8) == 8, "One word.");
+    static_assert(sizeof(P16) == 16, "Two words.");
+    static_assert(sizeof(A10) == 8, "Ten six-bit characters in one word.");
+    static_assert(sizeof(A20) == 16, "Twenty in two.");
+    constexpr P8 empty;
+    static_assert(empty.empty(), "Default is empty.");
+
+    CHECK(P8{"AB"}.word(0) == 0x4142000000000000ull);
+    CHECK(A10{"0"}.word(0) == std::uint64_t(2) << 58);
+}
+
+TEST_CASE("packed_symbol round trip", "[packed_symbol]")
+{
+    CHECK(P8{"IBM"}.unpack() == "IBM");
+    CHECK(P8{"ABCDEFGH"}.unpack() == "ABCDEFGH");
+    CHECK(P8{""}.size() == 0);
+    CHECK(P8{"IBM"}.size() == 3);
+    CHECK(P8{"IBM"}[1] == 'B');
+    CHECK(P8{"IBM"}[3] == '\0');
+
+    const ash::fixed_string<16> osi{"SPX 261218C05"};
+    CHECK(P16{osi}.unpack() == osi);
+    CHECK(P16{osi}.size() == osi.size());
+    CHECK(P16{"ABCDEFGHIJKLMNOP"}.size() == 16);
+
+    CHECK(A10{"BRK.B"}.unpack() == "BRK.B");
+    CHECK(A10{"abcXYZ0189"}.unpack() == "abcXYZ0189");
+    CHECK(A10{"abcXYZ0189"}.size() == 10);
+    CHECK(A20{ash::fixed_string<20>{"ESZ6.CME.F.2026.DEC"}}.unpack().str() == "ESZ6.CME.F.2026.DEC");
+
+    ash::fixed_string<8> stale{"ABCDEF"};
+    stale[2] = '\0';
+    CHECK(P8{stale} == P8{"AB"});
+    CHECK(P16{stale}.size() == 2);
+}
+
+TEST_CASE("packed_symbol errors", "[packed_symbol]")
+{
+    CHECK_THROWS_AS(P8{"ABCDEFGHI"}, std::length_error);
+    CHECK_THROWS_AS(P8{ash::fixed_string<12>{"ABCDEFGHI"}}, std::length_error);
+    CHECK_THROWS_AS(A10{"BRK/B"}, std::invalid_argument);
+    CHECK_THROWS_AS(A10{"ABCDEFGHIJK"}, std::length_error);
+
+    P8 sym{"IBM"};
+    CHECK(sym.assign("TOO LONG!", 9) == std::errc::value_too_large);
+    CHECK(sym == P8{"IBM"});
+    CHECK(sym.assign("MSFT", 2) == std::errc{});
+    CHECK(sym == P8{"MS"});
+}
+
+namespace {
+
+template<typename Packed, std::size_t N>
+void check_order(const std::string& alphabet)
+{
+    std::mt19937 gen{49};
+    std::uniform_int_distribution<std::size_t> len(0, N);
+    std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+    std::vector<std::string> strs;
+    for (int i = 0; i != 2'000; ++i) {
+        std::string s(len(gen), ' ');
+        for (auto& c : s)
+            c = alphabet[pick(gen)];
+        strs.push_back(s);
+    }
+    for (std::size_t i = 1; i != strs.size(); ++i) {
+        const Packed a{strs[i - 1].c_str()}, b{strs[i].c_str()};
+        REQUIRE((a < b) == (strs[i - 1] < strs[i]));
+        REQUIRE((a == b) == (strs[i - 1] == strs[i]));
+        REQUIRE(a.unpack() == strs[i - 1]);
+    }
+}
+
+} // namespace
+
+TEST_CASE("packed_symbol ordering", "[packed_symbol]")
+{
+    const std::string alnum =
+        ".0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    check_order<P8, 8>("AB C\x7f\x80\xff");
+    check_order<P16, 16>("AB C\x7f\x80\xff");
+    check_order<A10, 10>(alnum);
+    check_order<A20, 20>(alnum);
+}
+
+TEST_CASE("packed_symbol hashable", "[packed_symbol]")
+{
+    std::unordered_set<P16> set;
+    for (int i = 0; i != 1'000; ++i)
+        set.insert(P16{("OPT" + std::to_string(i * 7)).c_str()});
+    CHECK(set.size() == 1'000);
+    CHECK(set.count(P16{"OPT7"}) == 1);
+    CHECK(set.count(P16{"OPT8"}) == 0);
+}
+
+TEST_CASE("packed_symbol benchmark", "[.][benchmark][packed_symbol]")
+{
+    std::mt19937 gen{49};
+    std::uniform_int_distribution<int> letter('A', 'Z');
+    std::vector<ash::fixed_string<8>> strs;
+    for (int i = 0; i != 4'096; ++i) {
+        std::string s(1 + i % 8, ' ');
+        for (auto& c : s)
+            c = static_cast<char>(letter(gen));
+        strs.emplace_back(s);
+    }
+    std::vector<P8> packed;
+    for (const auto& s : strs)
+        packed.emplace_back(s);
+
+    const auto time_ms = [](const auto& xs) {
+        std::size_t sink = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep != 500; ++rep) {
+            for (std::size_t i = 1; i != xs.size(); ++i)
+                sink += (xs[i - 1] == xs[i]) + (xs[i - 1] < xs[i]);
+        }
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        CHECK(sink != 1);
+        return elapsed.count();
+    };
+
+    std::cout
+        << "2M == and < on 8-character symbols\n"
+        << "  fixed_string<8>   " << time_ms(strs) << " ms\n"
+        << "  packed_symbol<8>  " << time_ms(packed) << " ms\n";
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <ash/radix_sort.h>
+
+namespace {
+
+using D8 = ash::fixed_decimal<8>;
+
+// Large enough to be split over several threads.
+const std::size_t large = 5 * ash::details::block_runner::min_block + 17;
+
+template<class T>
+std::vector<T> random_ints(std::size_t n, long long lo, long long hi, unsigned seed)
+{
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<long long> dist{lo, hi};
+    std::vector<T> xs(n);
+    for (auto& x : xs)
+        x = static_cast<T>(dist(gen));
+    return xs;
+}
+
+std::vector<D8> random_prices(std::size_t n, long long lo, long long hi, unsigned seed)
+{
+    std::vector<D8> xs;
+    for (auto raw : random_ints<long long>(n, lo, hi, seed))
+        xs.push_back(D8::from_raw_value(raw));
+    return xs;
+}
+
+template<class T>
+void check_sort(std::vector<T> xs, unsigned n_threads = 1)
+{
+    auto expected = xs;
+    std::sort(expected.begin(), expected.end());
+    ash::radix_sort(ash::make_span(xs), n_threads);
+    CHECK(xs == expected);
+}
+
+bool raw_less(D8 a, D8 b)
+{
+    return a.raw_value() < b.raw_value();
+}
+
+} // namespace
+
+TEST_CASE("radix_sort integers", "[radix_sort]")
+{
+    using ll = long long;
+    constexpr ll ll_min = std::numeric_limits<ll>::min();
+    constexpr ll ll_max = std::numeric_limits<ll>::max();
+
+    for (std::size_t n : {0, 1, 2, 100, 255, 256, 1000, 10'000}) {
+        check_sort(random_ints<ll>(n, ll_min, ll_max, 1));
+        check_sort(random_ints<ll>(n, -1000, 1000, 2));
+        check_sort(random_ints<unsigned long long>(n, 0, ll_max, 3));
+        check_sort(random_ints<int>(n, -70'000, 70'000, 4));
+        check_sort(random_ints<std::int16_t>(n, -300, 300, 5));
+        check_sort(random_ints<std::int8_t>(n, -128, 127, 6));
+        check_sort(random_ints<std::uint8_t>(n, 0, 255, 7));
+    }
+
+    SECTION("extremes") {
+        std::vector<ll> xs(1000);
+        for (std::size_t i = 0; i != xs.size(); ++i) {
+            const ll vals[] = {ll_min, ll_max, -1, 0, 1, ll_min + 1, ll_max - 1};
+            xs[i] = vals[(i * 7919) % 7];
+        }
+        check_sort(xs);
+    }
+
+    SECTION("constant") {
+        check_sort(std::vector<ll>(5000, -42));
+    }
+}
+
+TEST_CASE("radix_sort fixed_decimal", "[radix_sort]")
+{
+    auto xs = random_prices(20'000, -100'000'000'000, 100'000'000'000, 11);
+    auto expected = xs;
+    std::sort(expected.begin(), expected.end(), raw_less);
+
+    ash::radix_sort(ash::make_span(xs));
+    CHECK(xs == expected);
+    CHECK(std::is_sorted(xs.begin(), xs.end()));
+}
+
+TEST_CASE("radix_argsort", "[radix_sort]")
+{
+    for (std::size_t n : {0, 10, 300, 20'000}) {
+        // Few distinct keys, so stability matters.
+        const auto keys = random_prices(n, -50, 50, 21);
+        std::vector<std::uint32_t> idx(n);
+        ash::radix_argsort(ash::make_span(keys), ash::make_span(idx));
+
+        std::vector<std::uint32_t> expected(n);
+        for (std::size_t i = 0; i != n; ++i)
+            expected[i] = static_cast<std::uint32_t>(i);
+        std::stable_sort(expected.begin(), expected.end(), [&](auto a, auto b) {
+            return raw_less(keys[a], keys[b]);
+        });
+        CHECK(idx == expected);
+    }
+}
+
+TEST_CASE("radix_sort parallel", "[radix_sort]")
+{
+    check_sort(random_ints<long long>(large, -1'000'000'000, 1'000'000'000, 31), 4);
+    check_sort(random_ints<int>(large, -10, 10, 32), 3);
+
+    const auto keys = random_ints<long long>(large, -1000, 1000, 33);
+    std::vector<std::size_t> serial(large), parallel(large);
+    ash::radix_argsort(ash::make_span(keys), ash::make_span(serial));
+    ash::radix_argsort(ash::make_span(keys), ash::make_span(parallel), 4);
+    CHECK(serial == parallel);
+    CHECK(std::is_sorted(serial.begin(), serial.end(), [&](auto a, auto b) {
+        return keys[a] < keys[b];
+    }));
+}
+
+TEST_CASE("radix_sort benchmark", "[.][benchmark][radix_sort]")
+{
+    const auto prices = random_prices(10'000'000, 1'000'000'000, 1'000'000'000'000, 41);
+    const auto time_ms = [](auto&& f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    };
+
+    auto a = prices;
+    const double std_ms = time_ms([&] { std::sort(a.begin(), a.end()); });
+    auto b = prices;
+    const double radix_ms = time_ms([&] { ash::radix_sort(ash::make_span(b)); });
+    CHECK(a == b);
+
+    std::vector<std::uint32_t> idx(prices.size());
+    const double arg_ms = time_ms([&] {
+        ash::radix_argsort(ash::make_span(prices), ash::make_span(idx));
+    });
+
+    std::cout
+        << "sort 10M fixed_decimal<8>\n"
+        << "  std::sort      " << std_ms << " ms\n"
+        << "  radix_sort     " << radix_ms << " ms\n"
+        << "  radix_argsort  " << arg_ms << " ms\n";
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include <Catch/catch.hpp>
+
+#include <ash/sized_string.h>
+
+using S4 = ash::sized_string<4, char>;
+using S8 = ash::sized_string<8, char>;
+using S16 = ash::sized_string<16, char>;
+
+TEST_CASE("sized string constexpr", "[sized_string]")
+{
+    constexpr S4 s("Hi");
+    static_assert(s.capacity() == 4, "Incorrect capacity.");
+    static_assert(s.size() == 2, "Incorrect size.");
+    static_assert(s.end() - s.begin() == 2, "Bad iterators.");
+    static_assert(sizeof(S16) == 17, "Unexpected overhead.");
+}
+
+TEST_CASE("sized string constructors", "[sized_string]")
+{
+    SECTION("default") {
+        S4 def{};
+        CHECK(def.size() == 0);
+        CHECK(def.empty());
+        CHECK(def == "");
+    }
+    SECTION("char pointer") {
+        const char* src = "const char*";
+        CHECK(S16{src} == src);
+        CHECK(S16(src, 5) == "const");
+        CHECK(S16("ab\0cd", 5).size() == 2);
+    }
+    SECTION("truncates") {
+        CHECK(S4{"const array"} == "cons");
+        CHECK(S4(5, 'a') == "aaaa");
+    }
+    SECTION("std::string") {
+        const std::string src{"const string"};
+        CHECK(S16{src} == src);
+        CHECK(S16{src}.str() == src);
+    }
+    SECTION("fixed_string") {
+        const ash::fixed_string<8> src{"fixed"};
+        CHECK(S16{src} == src);
+    }
+}
+
+TEST_CASE("sized string null termination", "[sized_string]")
+{
+    S4 s;
+    for (std::size_t i = 1; i <= 4; ++i) {
+        s.push_back('x');
+        CHECK(s.size() == i);
+        CHECK(std::strlen(s.c_str()) == i);
+        CHECK(s.available() == 4 - i);
+    }
+    CHECK(s.back() == 'x');
+    s.push_back('y');
+    CHECK(s == "xxxx");
+
+    s.pop_back();
+    CHECK(s == "xxx");
+    CHECK(s.c_str()[3] == '\0');
+    s.clear();
+    CHECK(s.empty());
+    CHECK(s == S4{});
+}
+
+TEST_CASE("sized string append", "[sized_string]")
+{
+    S8 s("ab");
+    s.append("cd").append(2, 'e').append(std::string("fghij"));
+    CHECK(s == "abcdeefg");
+    CHECK(s.size() == 8);
+
+    S8 t;
+    t += 'a';
+    t += "bc";
+    t += S4{"de"};
+    t += ash::fixed_string<4>{"f"};
+    CHECK(t == "abcdef");
+    CHECK(t.append("gh\0ij", 5) == "abcdefgh");
+}
+
+TEST_CASE("sized string append numbers", "[sized_string]")
+{
+    ash::sized_string<16> s("54=");
+    s.append(1).append("|44=").append(ash::fixed_decimal<4>::from_raw_value(-99));
+    CHECK(s == "54=1|44=-0.0099");
+    CHECK(s.size() == 15);
+    CHECK(s.try_append(10) == std::errc::value_too_large);
+    CHECK_THROWS_AS(s += 0.5, std::length_error);
+    CHECK(s.size() == 15);
+    s += 9ull;
+    CHECK(s == "54=1|44=-0.00999");
+    CHECK(s.available() == 0);
+
+    S8 t;
+    t.append(2.5, 1);
+    CHECK(t == "2.5");
+    CHECK(std::strlen(t.c_str()) == 3);
+}
+
+TEST_CASE("sized string comparison", "[sized_string]")
+{
+    S8 s{"Hello"};
+    CHECK(s == S8{"Hello"});
+    CHECK(s == S16{"Hello"});
+    CHECK(s == ash::fixed_string<5>{"Hello"});
+    CHECK(s == std::string{"Hello"});
+    CHECK(s != "Hell");
+    CHECK(s != "Hello!");
+    CHECK(s != S8{"Hell"});
+
+    CHECK(S8{"Hell"} < s);
+    CHECK(s < S16{"Help"});
+    CHECK_FALSE(s < s);
+    CHECK(s < std::string{"Hello!"});
+    CHECK(S16{"\xff"} > S16{"a"});
+
+    S8 popped{"Hello!"};
+    popped.pop_back();
+    CHECK(popped == s);
+}
+
+TEST_CASE("sized string find", "[sized_string]")
+{
+    const S16 s{"abcabcd"};
+    CHECK(s.find('c') == 2);
+    CHECK(s.find('c', 3) == 5);
+    CHECK(s.find('z') == S16::npos);
+    CHECK(s.find("abcd") == 3);
+    CHECK(s.find("cd", 6) == S16::npos);
+    CHECK(s.find("") == 0);
+    CHECK(s.rfind('c') == 5);
+    CHECK(s.rfind('c', 4) == 2);
+    CHECK(s.rfind("abc") == 3);
+    CHECK(s.rfind("abc", 2) == 0);
+    CHECK(s.find_first_of("dc") == 2);
+    CHECK(s.find_first_of("xyz") == S16::npos);
+}
+
+TEST_CASE("sized string hashable", "[sized_string]")
+{
+    std::unordered_map<S8, int> m;
+    m[S8{"IBM"}] = 1;
+    m[S8{"AAPL"}] = 2;
+    CHECK(m.at(S8{"IBM"}) == 1);
+    CHECK(m.at(S8{"AAPL"}) == 2);
+    CHECK(m.count(S8{"MSFT"}) == 0);
+
+    CHECK(std::hash<S8>{}(S8{"IBM"}) ==
+          std::hash<ash::fixed_string<8>>{}(ash::fixed_string<8>{"IBM"}));
+    S8 popped{"IBMX"};
+    popped.pop_back();
+    CHECK(std::hash<S8>{}(popped) == std::hash<S8>{}(S8{"IBM"}));
+}
+
+TEST_CASE("sized string benchmark", "[.][benchmark][sized_string]")
+{
+    constexpr int iterations = 1'000'000;
+    const auto time_ms = [](auto&& f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    };
+
+    std::size_t fixed_total = 0;
+    const double fixed_ms = time_ms([&] {
+        for (int i = 0; i != iterations; ++i) {
+            ash::fixed_string<64> s;
+            for (int j = 0; j != 64; ++j)
+                s.append(static_cast<char>('a' + (i + j) % 26));
+            fixed_total += s.size();
+        }
+    });
+    std::size_t sized_total = 0;
+    const double sized_ms = time_ms([&] {
+        for (int i = 0; i != iterations; ++i) {
+            ash::sized_string<64> s;
+            for (int j = 0; j != 64; ++j)
+                s.append(static_cast<char>('a' + (i + j) % 26));
+            sized_total += s.size();
+        }
+    });
+    CHECK(fixed_total == sized_total);
+
+    std::cout
+        << "append 64 chars, 1M strings\n"
+        << "  fixed_string  " << fixed_ms << " ms\n"
+        << "  sized_string  " << sized_ms << " ms\n";
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <string>
+
+#include <ash/soa_vector.h>
+
+using orders = ash::soa_vector<int, double, std::string>;
+
+TEST_CASE("soa vector push_back", "[soa_vector]")
+{
+    orders v;
+    CHECK(v.empty());
+    for (int i = 0; i != 100; ++i)
+        v.push_back(i, i * 0.5, std::to_string(i));
+    REQUIRE(v.size() == 100);
+    CHECK(v.capacity() >= 100);
+
+    CHECK(v.get<int>(42) == 42);
+    CHECK(v.get<double>(42) == Approx(21.0));
+    CHECK(v.get<std::string>(42) == "42");
+    CHECK_THROWS(v.at<int>(100));
+
+    auto ids = v.column<int>();
+    CHECK(ids.size() == 100);
+    CHECK(std::accumulate(ids.begin(), ids.end(), 0) == 4950);
+    CHECK(reinterpret_cast<std::uintptr_t>(ids.data()) % 64 == 0);
+}
+
+TEST_CASE("soa vector push_back own row", "[soa_vector]")
+{
+    orders v;
+    const std::string name(40, 'x');
+    v.push_back(7, 1.5, name);
+    while (v.size() != v.capacity())
+        v.push_back(0, 0.0, "");
+
+    // Growing must not free row 0 before it is copied.
+    const auto before = v.capacity();
+    v.push_back(v.get<int>(0), v.get<double>(0), v.get<std::string>(0));
+    CHECK(v.capacity() > before);
+    CHECK(v.get<int>(v.size() - 1) == 7);
+    CHECK(v.get<std::string>(v.size() - 1) == name);
+    CHECK(v.get<std::string>(0) == name);
+
+    while (v.size() != v.capacity())
+        v.push_back(0, 0.0, "");
+    v.emplace_back(v.get<int>(0), v.get<double>(0), std::move(v.get<std::string>(0)));
+    CHECK(v.get<std::string>(v.size() - 1) == name);
+}
+
+TEST_CASE("soa vector erase", "[soa_vector]")
+{
+    orders v;
+    for (int i = 0; i != 5; ++i)
+        v.push_back(i, i * 1.0, std::to_string(i));
+
+    SECTION("erase") {
+        v.erase(1);
+        REQUIRE(v.size() == 4);
+        CHECK(v.get<int>(1) == 2);
+        CHECK(v.get<std::string>(1) == "2");
+        CHECK(v.get<std::string>(3) == "4");
+    }
+    SECTION("swap_erase") {
+        v.swap_erase(1);
+        REQUIRE(v.size() == 4);
+        CHECK(v.get<int>(1) == 4);
+        CHECK(v.get<std::string>(1) == "4");
+        CHECK(v.get<double>(1) == Approx(4.0));
+    }
+    SECTION("pop_back") {
+        v.pop_back();
+        CHECK(v.size() == 4);
+        CHECK(v.column<std::string>().back() == "3");
+    }
+}
+
+TEST_CASE("soa vector copy and move", "[soa_vector]")
+{
+    orders v;
+    v.push_back(1, 1.0, "one");
+    orders copy{v};
+    orders moved{std::move(v)};
+    CHECK(v.empty());
+    CHECK(copy.get<std::string>(0) == "one");
+    CHECK(moved.get<std::string>(0) == "one");
+    copy = moved;
+    CHECK(copy.size() == 1);
+}
+
+TEST_CASE("soa vector from multipart", "[soa_vector]")
+{
+    ash::soa_vector_of_t<ash::multipart<int, std::string>> v;
+    ash::multipart<int, std::string> m;
+    m.get<int>() = 7;
+    m.get<std::string>() = "seven";
+    v.push_back(m);
+    CHECK(v.get<int>(0) == 7);
+    CHECK(v.get<std::string>(0) == "seven");
+}
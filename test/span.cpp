@@ -0,0 +1,53 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Catch/catch.hpp>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <ash/span.h>
+
+TEST_CASE("span construction", "[span]")
+{
+    int arr[] = {1, 2, 3, 4};
+    std::vector<int> vec{5, 6, 7};
+
+    ash::span<int> a{arr};
+    CHECK(a.size() == 4);
+    CHECK(a[2] == 3);
+
+    ash::span<const int> v{vec};
+    CHECK(v.size() == 3);
+    CHECK(v.data() == vec.data());
+    CHECK(std::accumulate(v.begin(), v.end(), 0) == 18);
+
+    ash::span<const int> c{a};
+    CHECK(c.data() == arr);
+}
+
+TEST_CASE("span subviews", "[span]")
+{
+    int arr[] = {1, 2, 3, 4, 5};
+    auto s = ash::make_span(arr, 5);
+    CHECK(s.first(2).back() == 2);
+    CHECK(s.last(2).front() == 4);
+    CHECK(s.subspan(1, 3).size() == 3);
+    CHECK(s.subspan(3).front() == 4);
+    CHECK(s.subspan(5).empty());
+}
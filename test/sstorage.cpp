@@ -17,8 +17,13 @@
 
 #include <Catch/catch.hpp>
 
-#include <vector>
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <vector>
 
 #include <ash/sstorage.h>
 
@@ -51,3 +56,137 @@ TEST_CASE("stable storage create", "[static_storage]")
     CHECK(store.chunk_count() == 2);
     CHECK_FALSE(&d + 1 == &e);
 }
+
+TEST_CASE("stable storage iteration", "[static_storage]")
+{
+    ash::stable_storage<int, 4> store;
+    CHECK(store.begin() == store.end());
+    CHECK(store.empty());
+
+    for (int i = 0; i != 10; ++i)
+        store.create(i);
+    REQUIRE(store.size() == 10);
+
+    SECTION("iterators") {
+        int expected = 0;
+        for (int x : store)
+            CHECK(x == expected++);
+        CHECK(expected == 10);
+
+        const auto& cstore = store;
+        CHECK(std::distance(cstore.begin(), cstore.end()) == 10);
+    }
+    SECTION("for_each") {
+        store.for_each([](int& x) { x *= 2; });
+        int sum = 0;
+        store.for_each([&](int x) { sum += x; });
+        CHECK(sum == 90);
+    }
+    SECTION("for_each_chunk") {
+        std::vector<std::ptrdiff_t> sizes;
+        store.for_each_chunk([&](int* first, int* last) {
+            sizes.push_back(last - first);
+        });
+        CHECK(sizes == (std::vector<std::ptrdiff_t>{4, 4, 2}));
+    }
+    SECTION("parallel_for_each") {
+        std::atomic<int> sum{0};
+        store.parallel_for_each([&](int x) { sum += x; }, 3);
+        CHECK(sum == 45);
+    }
+}
+
+TEST_CASE("stable storage dynamic chunks", "[static_storage]")
+{
+    ash::stable_storage<std::uint64_t> store;
+    CHECK(store.chunk_count() == 0);
+    CHECK(store.capacity() == 0);
+
+    const auto initial = store.initial_chunk_capacity;
+    for (std::uint64_t i = 0; i != initial + 1; ++i)
+        store.create(i);
+    CHECK(store.chunk_count() == 2);
+    CHECK(store.capacity() == 2 * initial);
+
+    for (std::uint64_t i = initial + 1; i != 2 * initial + 1; ++i)
+        store.create(i);
+    CHECK(store.chunk_count() == 3);
+    CHECK(store.capacity() == 4 * initial);
+
+    std::uint64_t expected = 0;
+    for (auto x : store)
+        CHECK(x == expected++);
+}
+
+TEST_CASE("stable storage reserve", "[static_storage]")
+{
+    SECTION("dynamic") {
+        ash::stable_storage<int> store;
+        store.reserve(1000);
+        REQUIRE(store.capacity() >= 1000);
+        const auto chunks = store.chunk_count();
+        auto& first = store.create(0);
+        for (int i = 1; i != 1000; ++i)
+            store.create(i);
+        CHECK(store.chunk_count() == chunks);
+        CHECK(&first + 999 == &*std::next(store.begin(), 999));
+    }
+    SECTION("fixed") {
+        ash::stable_storage<int, 4> store;
+        store.reserve(9);
+        CHECK(store.chunk_count() == 3);
+        for (int i = 0; i != 12; ++i)
+            store.create(i);
+        CHECK(store.chunk_count() == 3);
+    }
+    SECTION("clear reuses chunks") {
+        ash::stable_storage<int, 4> store;
+        for (int i = 0; i != 6; ++i)
+            store.create(i);
+        auto* const first = &*store.begin();
+        store.clear();
+        CHECK(store.empty());
+        CHECK(store.begin() == store.end());
+        CHECK(&store.create(1) == first);
+        CHECK(store.chunk_count() == 2);
+    }
+}
+
+TEST_CASE("stable storage parallel blocks", "[static_storage]")
+{
+    using storage_type = ash::stable_storage<int>;
+    const auto block = storage_type::min_parallel_block;
+    const auto n = static_cast<int>(4 * block);
+    storage_type store;
+    store.reserve(n);
+    for (int i = 0; i != n; ++i)
+        store.create(i);
+    REQUIRE(store.chunk_count() == 1);
+
+    std::mutex mtx;
+    std::vector<std::ptrdiff_t> sizes;
+    std::atomic<long long> sum{0};
+    store.parallel_for_each_chunk([&](int* first, int* last) {
+        sum += std::accumulate(first, last, 0LL);
+        std::lock_guard<std::mutex> lock{mtx};
+        sizes.push_back(last - first);
+    }, 4);
+
+    CHECK(sizes.size() == 4);
+    CHECK(std::accumulate(sizes.begin(), sizes.end(), std::ptrdiff_t{0}) == n);
+    CHECK(sum == static_cast<long long>(n) * (n - 1) / 2);
+}
+
+TEST_CASE("stable storage mmap upstream", "[static_storage]")
+{
+    using storage_type =
+        ash::stable_storage<int, ash::dynamic_chunk, ash::mmap_alloc>;
+    storage_type store{ash::mmap_alloc{true, 1 << 16}};
+    store.reserve(1 << 20);
+    for (int i = 0; i != (1 << 20); ++i)
+        store.create(i);
+    CHECK(store.chunk_count() == 1);
+    long long sum = 0;
+    store.for_each([&](int x) { sum += x; });
+    CHECK(sum == (1LL << 20) * ((1 << 20) - 1) / 2);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2016 Howard, Terrance <heyterrance@gmail.com>
+ * Author: Howard, Terrance <heyterrance@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <Catch/catch.hpp>
+
+#include <ash/symbol_table.h>
+
+using table = ash::symbol_table<16>;
+
+TEST_CASE("symbol", "[symbol_table]")
+{
+    constexpr ash::symbol none;
+    static_assert(not none.valid(), "Default symbol is invalid.");
+    CHECK(ash::symbol{3} == ash::symbol{3});
+    CHECK(ash::symbol{2} < ash::symbol{3});
+    CHECK(std::hash<ash::symbol>{}(ash::symbol{7}) == 7);
+    CHECK(sizeof(ash::symbol) == 4);
+}
+
+TEST_CASE("symbol_table interning", "[symbol_table]")
+{
+    table t{100};
+    CHECK(t.size() == 0);
+    CHECK_FALSE(t.find("IBM"));
+
+    const ash::symbol ibm = t.intern("IBM");
+    const ash::symbol msft = t.intern("MSFT");
+    CHECK(ibm.id() == 0);
+    CHECK(msft.id() == 1);
+    CHECK(t.intern("IBM") == ibm);
+    CHECK(t.find("MSFT") == msft);
+    CHECK(t.size() == 2);
+    CHECK(t.name(ibm) == "IBM");
+    CHECK(t[msft] == "MSFT");
+
+    table::string_type stale{"IBMX"};
+    stale[3] = '\0';
+    CHECK(t.find(stale) == ibm);
+
+    for (int i = 2; i != 100; ++i)
+        CHECK(t.intern(std::to_string(i)).id() == static_cast<std::uint32_t>(i));
+    CHECK(t.size() == 100);
+    CHECK(t.find("99").id() == 99);
+    CHECK_THROWS_AS(t.intern("one more"), std::length_error);
+    CHECK(t.intern("IBM") == ibm);
+}
+
+TEST_CASE("symbol_table ids index arrays", "[symbol_table]")
+{
+    table t{8};
+    std::vector<int> qty(t.max_size());
+    qty[t.intern("IBM").id()] += 100;
+    qty[t.intern("AAPL").id()] += 5;
+    qty[t.intern("IBM").id()] -= 30;
+    CHECK(qty[t.find("IBM").id()] == 70);
+
+    std::unordered_map<ash::symbol, int> m;
+    m[t.find("AAPL")] = 1;
+    CHECK(m.at(t.intern("AAPL")) == 1);
+}
+
+TEST_CASE("symbol_table concurrent readers", "[symbol_table]")
+{
+    constexpr int n = 20'000;
+    table t{n};
+    std::atomic<bool> done{false};
+    std::atomic<int> errors{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r != 3; ++r) {
+        readers.emplace_back([&] {
+            while (not done.load()) {
+                const std::size_t size = t.size();
+                for (std::size_t id = 0; id < size; id += 97) {
+                    const ash::symbol sym{static_cast<std::uint32_t>(id)};
+                    if (t.find(t.name(sym)) != sym)
+                        ++errors;
+                }
+            }
+        });
+    }
+    std::thread writer{[&] {
+        for (int i = 0; i != n; ++i)
+            t.intern("S" + std::to_string(i));
+    }};
+    for (int i = 0; i != n; ++i)
+        t.intern("S" + std::to_string(n - 1 - i));
+    writer.join();
+    done = true;
+    for (auto& thd : readers)
+        thd.join();
+
+    CHECK(errors == 0);
+    CHECK(t.size() == static_cast<std::size_t>(n));
+    for (int i = 0; i != n; ++i)
+        REQUIRE(t.name(t.find("S" + std::to_string(i))) == ("S" + std::to_string(i)).c_str());
+}
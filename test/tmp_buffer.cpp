@@ -17,6 +17,8 @@
 
 #include <Catch/catch.hpp>
 
+#include <cstdint>
+
 #include <ash/tmp_buffer.h>
 
 TEST_CASE("unique tmp buffer constructor", "[tmp_buffer, constructor]")
@@ -58,3 +60,68 @@ TEST_CASE("unique tmp buffer iteration", "[tmp_buffer]")
     }
 }
 
+TEST_CASE("unique tmp buffer scratch arena", "[tmp_buffer]")
+{
+    using buffer = ash::unique_tmp_buffer<double>;
+    const auto& arena = ash::details::scratch_arena::local();
+    const auto used = arena.used();
+
+    SECTION("pointer bump") {
+        buffer a{16};
+        buffer b{16};
+        CHECK(arena.owns(a.data()));
+        CHECK(arena.owns(b.data()));
+        CHECK(b.data() > a.data());
+    }
+    SECTION("lifo reuse") {
+        double* first = nullptr;
+        {
+            buffer a{32};
+            first = a.data();
+        }
+        CHECK(arena.used() == used);
+        buffer b{32};
+        CHECK(b.data() == first);
+    }
+    SECTION("out of order release") {
+        buffer a{8};
+        auto* b = new buffer{8};
+        buffer c{8};
+        a.reset();
+        CHECK(arena.used() > used);
+        c.reset();
+        delete b;
+        CHECK(arena.used() == used);
+    }
+    SECTION("heap fallback") {
+        buffer big{ash::details::scratch_arena::arena_size};
+        REQUIRE(big.size() != 0);
+        CHECK_FALSE(arena.owns(big.data()));
+    }
+    CHECK(arena.used() == used);
+}
+
+TEST_CASE("unique tmp buffer alignment", "[tmp_buffer]")
+{
+    SECTION("aligned") {
+        ash::unique_tmp_buffer<char> pad{1};
+        ash::unique_tmp_buffer<float, 32> b{10};
+        REQUIRE(b.size() == 10);
+        CHECK(reinterpret_cast<std::uintptr_t>(b.data()) % 32 == 0);
+        CHECK(b.padded_size() == 16);
+    }
+    SECTION("over aligned heap fallback") {
+        ash::unique_tmp_buffer<char, 128> b{
+            ash::details::scratch_arena::arena_size};
+        REQUIRE(b.size() != 0);
+        CHECK(reinterpret_cast<std::uintptr_t>(b.data()) % 128 == 0);
+    }
+    SECTION("huge pages") {
+        const std::ptrdiff_t n = (4 << 20) / sizeof(double);
+        ash::simd_tmp_buffer<double> b{n};
+        REQUIRE(b.size() == n);
+        CHECK(reinterpret_cast<std::uintptr_t>(b.data()) % (2 << 20) == 0);
+        b[n - 1] = 1.0;
+        CHECK(b[n - 1] == Approx(1.0));
+    }
+}